@@ -0,0 +1,355 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "analysis.h"
+#include "parser.h"
+#include "program_generator.h"
+#include "tokens.h"
+
+// Every allocation of the process is counted, so that each phase can report
+// how many it made.
+namespace {
+
+std::atomic<uint64_t> allocation_count = 0;
+std::atomic<uint64_t> allocated_bytes = 0;
+
+void* CountedAllocate(size_t size, std::align_val_t align = std::align_val_t{__STDCPP_DEFAULT_NEW_ALIGNMENT__}) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    const auto alignment = std::max(static_cast<size_t>(align), sizeof(void*));
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, std::max<size_t>(size, 1)) != 0) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+}
+
+void* operator new(size_t size) {
+    return CountedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+    return CountedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    return CountedAllocate(size, align);
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    return CountedAllocate(size, align);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkCase {
+    std::string name;
+    ProgramShape shape;
+    uint64_t seed;
+};
+
+// Fixed shapes and seeds, so that results can be compared between commits.
+std::vector<BenchmarkCase> DefaultSuite() {
+    return {
+        {"straight", {.statements = 200000, .max_depth = 0, .variables = 20, .operands = 2}, 1},
+        {"branches", {.statements = 50000, .max_depth = 3, .variables = 12, .branch_percent = 25, .loop_percent = 0}, 2},
+        {"counted-loops", {.statements = 5000, .max_depth = 2, .variables = 8, .loop_percent = 100, .computable_loop_percent = 100}, 3},
+        {"unknown-loops", {.statements = 5000, .max_depth = 2, .variables = 8, .loop_percent = 100, .computable_loop_percent = 0}, 4},
+        {"wide-expressions", {.statements = 20000, .max_depth = 1, .variables = 16, .operands = 6}, 5},
+        {"many-variables", {.statements = 50000, .max_depth = 2, .variables = 5000, .operands = 2}, 6},
+    };
+}
+
+struct Options {
+    std::vector<BenchmarkCase> cases = DefaultSuite();
+    ValueDomain domain = ValueDomain::kValueSet;
+    uint32_t repeat = 3;
+    // Writes the programs to stdout instead of measuring them.
+    bool dump = false;
+};
+
+struct Measurement {
+    std::string phase;
+    // The fastest of the repetitions.
+    double time_ms = 0;
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t peak_rss_kb = 0;
+};
+
+// Lets the peak resident set size be measured per phase, where the system
+// allows it to be reset. Memory freed by earlier phases is handed back first,
+// as far as the allocator lets it go.
+void ResetPeakRss() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+uint64_t PeakRssKb() {
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.starts_with("VmHWM:")) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss);
+}
+
+// Runs `prepare` and then `work` `repeat` times; only `work` is measured.
+Measurement Measure(std::string phase,
+                    uint32_t repeat,
+                    const std::function<void()>& prepare,
+                    const std::function<void()>& work) {
+    Measurement measurement{.phase = std::move(phase), .time_ms = 1e300};
+    for (uint32_t i = 0; i < repeat; ++i) {
+        prepare();
+        ResetPeakRss();
+        const auto allocations = allocation_count.load();
+        const auto bytes = allocated_bytes.load();
+        const auto start = Clock::now();
+        work();
+        const auto time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        measurement.time_ms = std::min(measurement.time_ms, time);
+        measurement.allocations = allocation_count.load() - allocations;
+        measurement.allocated_bytes = allocated_bytes.load() - bytes;
+        measurement.peak_rss_kb = std::max(measurement.peak_rss_kb, PeakRssKb());
+    }
+    return measurement;
+}
+
+struct CaseResult {
+    size_t source_bytes = 0;
+    size_t tokens = 0;
+    std::vector<Measurement> measurements{};
+};
+
+CaseResult Run(const BenchmarkCase& benchmark, const Options& options) {
+    const auto source = GenerateProgram(benchmark.shape, benchmark.seed);
+    const auto nothing = [] {};
+    CaseResult result{.source_bytes = source.size()};
+    auto& tokens = result.tokens;
+    auto& measurements = result.measurements;
+
+    measurements.push_back(Measure("lex", options.repeat, nothing, [&] {
+        tokens = 0;
+        std::string_view rest = source;
+        while (NextToken(rest).has_value()) {
+            ++tokens;
+        }
+    }));
+
+    std::unique_ptr<Program> program;
+    measurements.push_back(Measure("parse", options.repeat, [&] { program.reset(); }, [&] {
+        program = Parser(source).ParseProgram();
+    }));
+
+    measurements.push_back(Measure("possible_values", options.repeat, nothing, [&] {
+        PossibleValueAnalyzer analyser;
+        analyser.domain = options.domain;
+        analyser.Analyse(*program);
+    }));
+    measurements.push_back(Measure("live_variables", options.repeat, nothing, [&] {
+        LiveVariableAnalyser analyser;
+        analyser.Analyse(*program);
+    }));
+    measurements.push_back(Measure("mixed", options.repeat, nothing, [&] {
+        MixedAnalyser analyser;
+        analyser.possible_value_analyzer.domain = options.domain;
+        analyser.Analyse(*program);
+    }));
+    measurements.push_back(Measure("ssa", options.repeat, nothing, [&] {
+        SsaAnalyser analyser;
+        analyser.Analyse(*program);
+    }));
+    return result;
+}
+
+void PrintJson(const BenchmarkCase& benchmark, const CaseResult& result, bool last, std::ostream& out) {
+    const auto& shape = benchmark.shape;
+    const auto& measurements = result.measurements;
+    out << "    {\n"
+        << "      \"name\": \"" << benchmark.name << "\",\n"
+        << "      \"seed\": " << benchmark.seed << ",\n"
+        << "      \"shape\": {\"statements\": " << shape.statements
+        << ", \"max_depth\": " << shape.max_depth
+        << ", \"variables\": " << shape.variables
+        << ", \"operands\": " << shape.operands
+        << ", \"branch_percent\": " << shape.branch_percent
+        << ", \"loop_percent\": " << shape.loop_percent
+        << ", \"computable_loop_percent\": " << shape.computable_loop_percent << "},\n"
+        << "      \"source_bytes\": " << result.source_bytes << ",\n"
+        << "      \"tokens\": " << result.tokens << ",\n"
+        << "      \"phases\": [\n";
+    for (size_t i = 0; i < measurements.size(); ++i) {
+        const auto& m = measurements[i];
+        out << "        {\"phase\": \"" << m.phase << "\""
+            << ", \"time_ms\": " << m.time_ms
+            << ", \"allocations\": " << m.allocations
+            << ", \"allocated_bytes\": " << m.allocated_bytes
+            << ", \"peak_rss_kb\": " << m.peak_rss_kb;
+        if (m.phase == "lex") {
+            out << ", \"mb_per_s\": " << static_cast<double>(result.source_bytes) / 1000 / m.time_ms;
+        }
+        out << "}" << (i + 1 < measurements.size() ? "," : "") << "\n";
+    }
+    out << "      ]\n"
+        << "    }" << (last ? "" : ",") << "\n";
+}
+
+bool ParseNumber(std::string_view value, uint64_t& number) {
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+    return error == std::errc{} && end == value.data() + value.size();
+}
+
+std::optional<Options> ParseOptions(int argc, char* argv[]) {
+    Options options;
+    std::optional<BenchmarkCase> custom;
+    std::optional<uint64_t> seed;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const auto separator = arg.find('=');
+        const auto name = arg.substr(0, separator);
+        const auto value = separator == std::string_view::npos ? std::string_view{} : arg.substr(separator + 1);
+        uint64_t number = 0;
+        const bool numeric = ParseNumber(value, number);
+
+        // Any of the shape options replaces the suite with a single program
+        // of that shape.
+        const auto shape = [&]() -> ProgramShape& {
+            if (!custom) {
+                custom = BenchmarkCase{"custom", {}, 0};
+            }
+            return custom->shape;
+        };
+        if (arg == "--dump") {
+            options.dump = true;
+        } else if (arg == "--domain=set") {
+            options.domain = ValueDomain::kValueSet;
+        } else if (arg == "--domain=interval") {
+            options.domain = ValueDomain::kInterval;
+        } else if (name == "--case") {
+            std::erase_if(options.cases, [&](const BenchmarkCase& c) { return c.name != value; });
+            if (options.cases.empty()) {
+                return {};
+            }
+        } else if (!numeric) {
+            return {};
+        } else if (name == "--repeat" && number > 0) {
+            options.repeat = static_cast<uint32_t>(number);
+        } else if (name == "--seed") {
+            seed = number;
+        } else if (name == "--statements") {
+            shape().statements = static_cast<uint32_t>(number);
+        } else if (name == "--depth") {
+            shape().max_depth = static_cast<uint32_t>(number);
+        } else if (name == "--variables") {
+            shape().variables = static_cast<uint32_t>(number);
+        } else if (name == "--operands") {
+            shape().operands = static_cast<uint32_t>(number);
+        } else if (name == "--branches" && number <= 100) {
+            shape().branch_percent = static_cast<uint32_t>(number);
+        } else if (name == "--loops" && number <= 100) {
+            shape().loop_percent = static_cast<uint32_t>(number);
+        } else if (name == "--computable" && number <= 100) {
+            shape().computable_loop_percent = static_cast<uint32_t>(number);
+        } else {
+            return {};
+        }
+    }
+    if (custom) {
+        options.cases = {*custom};
+    }
+    if (seed) {
+        for (auto& c: options.cases) {
+            c.seed = *seed;
+        }
+    }
+    return options;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const auto options = ParseOptions(argc, argv);
+    if (!options) {
+        std::cerr << "Usage: " << argv[0] << " [--case=NAME] [--seed=N] [--repeat=N] [--domain=set|interval] [--dump]\n"
+                  << "       [--statements=N] [--depth=N] [--variables=N] [--operands=N]\n"
+                  << "       [--branches=PERCENT] [--loops=PERCENT] [--computable=PERCENT]" << std::endl;
+        return 1;
+    }
+    if (options->dump) {
+        for (const auto& benchmark: options->cases) {
+            std::cout << GenerateProgram(benchmark.shape, benchmark.seed);
+        }
+        return 0;
+    }
+    std::cout << "{\n"
+              << "  \"domain\": \"" << (options->domain == ValueDomain::kInterval ? "interval" : "set") << "\",\n"
+              << "  \"repeat\": " << options->repeat << ",\n"
+              << "  \"cases\": [\n";
+    for (size_t i = 0; i < options->cases.size(); ++i) {
+        const auto& benchmark = options->cases[i];
+        PrintJson(benchmark, Run(benchmark, *options), i + 1 == options->cases.size(), std::cout);
+    }
+    std::cout << "  ]\n"
+              << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,166 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include "program_generator.h"
+
+namespace {
+
+constexpr uint32_t kMaxDepth = 8;
+constexpr uint32_t kMaxTripCount = 40;
+
+// splitmix64, used instead of the standard distributions, whose results are
+// left to the implementation.
+class Random {
+    uint64_t state_;
+
+public:
+    explicit Random(uint64_t seed) : state_(seed) {}
+
+    uint64_t Next() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t Below(uint32_t bound) {
+        return static_cast<uint32_t>(Next() % bound);
+    }
+
+    bool Percent(uint32_t percent) {
+        return Below(100) < percent;
+    }
+};
+
+class Generator {
+    const ProgramShape& shape_;
+    Random random_;
+    std::string out_{};
+    uint32_t left_;
+
+    void Indent(uint32_t depth) {
+        out_.append(2 * depth, ' ');
+    }
+
+    // The letters below the loop counters, then 'v' followed by the rest of
+    // the index in base 26, which no keyword or single letter can be.
+    void Variable() {
+        const uint32_t letters = 26 - shape_.max_depth;
+        uint32_t index = random_.Below(shape_.variables);
+        if (index < letters) {
+            out_ += static_cast<char>('a' + index);
+            return;
+        }
+        out_ += 'v';
+        index -= letters;
+        do {
+            out_ += static_cast<char>('a' + index % 26);
+            index /= 26;
+        } while (index > 0);
+    }
+
+    void Operand() {
+        if (random_.Percent(30)) {
+            // Never 0, so that constant divisions can be folded.
+            out_ += std::to_string(1 + random_.Below(99));
+        } else {
+            Variable();
+        }
+    }
+
+    void Expression() {
+        constexpr char kOperators[] = {'+', '-', '*', '/'};
+        Operand();
+        for (uint32_t i = 1; i < shape_.operands; ++i) {
+            out_ += ' ';
+            out_ += kOperators[random_.Below(4)];
+            out_ += ' ';
+            Operand();
+        }
+    }
+
+    void Condition() {
+        Expression();
+        out_ += random_.Percent(50) ? " < " : " > ";
+        Expression();
+    }
+
+    void Assignment(uint32_t depth) {
+        Indent(depth);
+        Variable();
+        out_ += " = ";
+        Expression();
+        out_ += '\n';
+        --left_;
+    }
+
+    void Branch(uint32_t depth) {
+        const bool loop = random_.Percent(shape_.loop_percent);
+        const bool counted = loop && random_.Percent(shape_.computable_loop_percent);
+        const char counter = static_cast<char>('z' - depth);
+        if (counted) {
+            Indent(depth);
+            out_ += counter;
+            out_ += " = 0\n";
+        }
+        Indent(depth);
+        out_ += loop ? "while (" : "if (";
+        if (counted) {
+            out_ += counter;
+            out_ += " < " + std::to_string(1 + random_.Below(kMaxTripCount));
+        } else {
+            Condition();
+        }
+        out_ += ")\n";
+        // The increment of a counted loop is taken out before its body, which
+        // may use up everything left.
+        left_ -= counted ? 3 : 1;
+        // At least one statement, and the body gets smaller further down.
+        const uint32_t body = 1 + random_.Below(std::max(1u, std::min(left_, 2 * (shape_.max_depth - depth) + 2)));
+        Statements(depth + 1, body);
+        if (counted) {
+            Indent(depth + 1);
+            out_ += counter;
+            out_ += " = ";
+            out_ += counter;
+            out_ += " + 1\n";
+        }
+        Indent(depth);
+        out_ += "end\n";
+    }
+
+    void Statements(uint32_t depth, uint32_t count) {
+        for (uint32_t i = 0; i < count && left_ > 0; ++i) {
+            // Room for the statements of a counted loop: its counter, the
+            // loop, one statement of the body and the increment.
+            if (depth < shape_.max_depth && left_ >= 4 && random_.Percent(shape_.branch_percent)) {
+                Branch(depth);
+            } else {
+                Assignment(depth);
+            }
+        }
+    }
+
+public:
+    Generator(const ProgramShape& shape, uint64_t seed)
+        : shape_(shape), random_(seed), left_(shape.statements) {}
+
+    std::string Generate() && {
+        while (left_ > 0) {
+            Statements(0, left_);
+        }
+        return std::move(out_);
+    }
+};
+
+}
+
+std::string GenerateProgram(const ProgramShape& shape, uint64_t seed) {
+    auto checked = shape;
+    checked.max_depth = std::min(checked.max_depth, kMaxDepth);
+    checked.variables = std::max(checked.variables, 1u);
+    checked.operands = std::max(checked.operands, 1u);
+    return Generator(checked, seed).Generate();
+}
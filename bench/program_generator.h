@@ -0,0 +1,33 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Shape of a generated program. Statements are counted at every level of
+// nesting, including the ifs and whiles themselves.
+struct ProgramShape {
+    uint32_t statements = 1000;
+    // Deepest nesting of ifs and whiles; 0 gives straight-line code.
+    uint32_t max_depth = 2;
+    // Variables in use, named 'a' on while single letters are left and with
+    // longer names after that. Loop counters are taken from 'z' downwards,
+    // one per level of nesting, and are not counted here.
+    uint32_t variables = 8;
+    // Operands of the right-hand side of an assignment or of one side of a
+    // condition.
+    uint32_t operands = 2;
+    // Chance, in percent, that a statement opens an if or a while.
+    uint32_t branch_percent = 20;
+    uint32_t loop_percent = 50;
+    // Chance, in percent, that a loop counts a counter up to a constant, so
+    // that its trip count can be computed, rather than test other variables.
+    uint32_t computable_loop_percent = 50;
+};
+
+// Generates a valid program of the given shape. The same seed always gives
+// the same program, whatever the platform.
+std::string GenerateProgram(const ProgramShape& shape, uint64_t seed);
@@ -4,51 +4,130 @@
 
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <optional>
 #include <set>
+#include <string>
+#include <unordered_map>
 
 #include "ast.h"
-
-struct LiveVariableAnalyser : StatementVisitor {
-    std::set<char> live_in_succ{};
-    std::vector<std::shared_ptr<Statement>> unused{};
+#include "budget.h"
+#include "cfg.h"
+#include "compiled_expression.h"
+#include "ssa.h"
+#include "value_state.h"
+
+// The version of what the analysers report. Every change that can make any
+// of them report differently on some program must bump it, since cached
+// reports are keyed by it (see ResultCache).
+constexpr uint32_t kAnalysisVersion = 3;
+
+struct LiveVariableAnalyser {
+    // The names live after the analysed code, and once it is analysed, those
+    // live before it.
+    VarSet live_in_succ{};
+    // In program order.
+    std::vector<Statement*> unused{};
 
     virtual void Analyse(Program &p);
 
-    void Visit(StatementList &sl) override;
-
-    void Visit(Assignment &stmt) override;
-
-    void Visit(IfStatement &stmt) override;
+    // Solves liveness over the graph, given the names live at its exit in
+    // live_in_succ; the assignments in its pruned statements are all unused.
+    void Analyse(const Cfg &cfg);
 
-    void Visit(WhileStatement &stmt) override;
+    virtual ~LiveVariableAnalyser() = default;
 };
 
-struct WriteNamesCollector : StatementVisitor {
-    std::set<char> names{};
-
-    void Visit(StatementList &sl) override;
-
-    void Visit(Assignment &stmt) override;
-
-    void Visit(IfStatement &stmt) override;
-
-    void Visit(WhileStatement &stmt) override;
+enum class ValueDomain {
+    // Exact sets of values; loops are unrolled up to kMaxDepth times.
+    kValueSet,
+    // Exact sets while they are small and ranges beyond that; loops are
+    // solved with widening and narrowing.
+    kInterval,
 };
 
-struct PossibleValueAnalyzer : StatementVisitor {
+struct PossibleValueAnalyzer : IterativeVisitor {
     constexpr static int kMaxCombinationCount = 32;
     constexpr static int kMaxDepth = 32;
-
-    std::map<char, std::set<int>> possible_values{};
-    std::vector<std::shared_ptr<Statement>> never_happens{};
-    std::vector<std::shared_ptr<Statement>> always_happens{};
+    constexpr static int kWideningDelay = 2;
+    constexpr static size_t kMaxLoopExits = 4096;
+    static_assert(kMaxCombinationCount <= ValueSet::kCapacity);
+
+    struct State {
+        ValueState possible_values;
+
+        bool operator==(const State& other) const = default;
+    };
+
+    ValueDomain domain = ValueDomain::kValueSet;
+    // Restarted by Analyse. Once it runs out, loops are no longer unrolled in
+    // the set domain nor widened late in the interval domain.
+    Budget budget{};
+    // The loops analysed at reduced precision because the budget ran out, in
+    // program order.
+    std::vector<const WhileStatement*> reduced_precision{};
+    // In the interval domain, variables without an exact set of values may
+    // have a range.
+    ValueState possible_values{};
+    // Interval domain only: cleared when the code analysed so far never
+    // finishes, e.g. ends in an infinite loop.
+    bool reachable = true;
+    // Indexed by Statement::id.
+    std::vector<bool> never_happens{};
+    std::vector<bool> always_happens{};
+    // Set domain: whether the branch of the statement was decided yet. A
+    // statement may be analysed more than once, within an unrolled loop, and
+    // its facts must hold every time.
+    std::vector<bool> branch_seen{};
+    // The expression of each statement, compiled on first use.
+    std::vector<CompiledExpression> compiled_expressions{};
+    std::vector<int> lane_values{};
+    // Of the names of the expression being evaluated, in order.
+    std::vector<const int*> lanes{};
+    std::vector<Interval> ranges{};
+    std::vector<int> evaluation_stack{};
+    std::vector<Interval> range_stack{};
+
+    // Set domain: an if statement, or one iteration of a loop, whose body is
+    // being analysed, with the values of the path skipping it when both paths
+    // are possible.
+    struct Pending {
+        Statement* statement;
+        int depth;
+        std::optional<ValueState> skipped;
+        // The first iteration of a loop within another one: the values on
+        // entering it, see loop_exits.
+        ValueState entry{};
+    };
+
+    std::vector<Pending> pending{};
+    // Set domain: the loops being iterated, which the loops within them are
+    // analysed once per iteration of.
+    int open_loops = 0;
+
+    // Set domain: the values after a loop within another one, for the values
+    // on entering it of the names it reads or writes. Keyed by LoopKey.
+    struct LoopExit {
+        const WhileStatement* loop;
+        ValueState entry;
+        ValueState exit;
+    };
+
+    std::unordered_map<uint64_t, LoopExit> loop_exits{};
 
     virtual void Analyse(Program &p);
 
-    void Visit(StatementList &sl) override;
+    // Analyses the statements as the continuation of the code analysed so
+    // far, starting from the current values. The facts are replaced by those
+    // of the statements, whose ids must be below statement_count.
+    void AnalyseNext(StatementList statements, uint32_t statement_count);
+
+    using IterativeVisitor::Visit;
 
-    void EvalExpr(Expression& expr, std::set<int>& values);
+    const CompiledExpression& Compile(const Statement& stmt, const Expression& expr, std::span<const Symbol> names);
+
+    void EvalExpr(const CompiledExpression& expr, ValueSet& values);
 
     void Visit(Assignment &assignment) override;
 
@@ -56,27 +135,116 @@ struct PossibleValueAnalyzer : StatementVisitor {
 
     void Visit(WhileStatement &while_statement) override;
 
-    void Visit(WhileStatement &while_statement, int depth);
-};
+    // Set domain: summarises a loop that only steps a variable towards a bound
+    // its body leaves alone, such as `while (x < n) x = x + 1 end`, by the
+    // values of its last iteration, whatever its trip count. Returns false,
+    // having changed nothing, for other loops and when the starts and bounds
+    // make too many combinations.
+    bool SummarizeInductionLoop(WhileStatement &while_statement);
+
+    uint64_t LoopKey(const WhileStatement &while_statement, const ValueState &entry) const;
+
+    // Set domain: takes the values after the loop from loop_exits, if it was
+    // analysed from the same values before; returns whether it was.
+    bool ReuseLoopExit(const WhileStatement &while_statement);
+
+    void StoreLoopExit(const WhileStatement &while_statement, ValueState entry);
+
+    // Starts the iteration of the loop at `depth`, and returns whether its
+    // body is to be analysed.
+    bool Visit(WhileStatement &while_statement, int depth);
+
+    // Set domain: stops iterating the loop as if it may run any number of
+    // times more. The names it writes become unknown, and the branches within
+    // it may go either way, whatever the iterations so far found.
+    void GiveUp(const WhileStatement &while_statement);
+
+    void Leave(IfStatement &if_statement) override;
 
-struct AssignmentCollector : StatementVisitor {
-    std::vector<std::shared_ptr<Statement>> assignments{};
+    void Leave(WhileStatement &while_statement) override;
 
-    void Visit(StatementList &sl) override;
+    // Set domain: records whether the condition of an if statement, or that
+    // of a loop on entry, can be true and false this time.
+    void RecordBranch(const Statement &stmt, bool can_be_true, bool can_be_false);
 
-    void Visit(Assignment &stmt) override;
+    // Set domain: joins the values after a body with those of the path that
+    // skipped it. Only the names the body writes can differ.
+    void MergeSkipped(const ValueState& skipped, std::span<const Symbol> writes);
 
-    void Visit(IfStatement &stmt) override;
+    // Interval domain, solved over the control-flow graph.
+    void AnalyseRanges(const Cfg &cfg);
 
-    void Visit(WhileStatement &stmt) override;
+    State Snapshot() const;
+
+    void Restore(State state);
+
+    Interval RangeOf(Symbol name);
+
+    void SetRange(Symbol name, Interval range);
+
+    void EvalValue(const CompiledExpression& expr, ValueSet& values, Interval& range);
+
+    std::pair<bool, bool> EvalCondition(const CompiledExpression& expr);
+
+    bool Refine(const Expression& condition, bool outcome);
+
+    void Join(const State& other);
+
+    void Widen(const State& previous);
+
+    void Narrow(const State& previous);
+
+    bool IsIncludedIn(const State& other);
+
+    void VisitRanges(Assignment &assignment);
 };
 
+// How a loop of PossibleValueAnalyzer::reduced_precision is reported.
+std::string ReducedPrecisionLine(const WhileStatement &loop);
+
 struct MixedAnalyser : LiveVariableAnalyser {
     PossibleValueAnalyzer possible_value_analyzer{};
 
     void Analyse(Program &p) override;
+};
 
-    void Visit(IfStatement &stmt) override;
+// Finds the same unused assignments on the static single assignment form of
+// the program. Branches are decided by sparse conditional constant
+// propagation, and an assignment is used when its value reaches a read along
+// the def-use chains, through any phis on the way.
+struct SsaAnalyser {
+    // Indexed by Statement::id, as those of PossibleValueAnalyzer.
+    std::vector<bool> never_happens{};
+    std::vector<bool> always_happens{};
+    // In program order.
+    std::vector<Statement*> unused{};
+
+    void Analyse(Program &p);
+};
+// Analyses a program one top-level statement at a time, as the parser
+// produces them, so that every statement can be released once analysed.
+// Unused assignments are found forwards, as those reaching no read, and are
+// reported as soon as that is known: the ones that may still be read come out
+// of a later call or of Finish.
+struct StreamingAnalyser {
+    // Assignments are identified by their position among all the statements
+    // of the program.
+    using Definitions = std::unordered_map<Symbol, std::set<uint64_t>>;
 
-    void Visit(WhileStatement &stmt) override;
-};
\ No newline at end of file
+    PossibleValueAnalyzer possible_value_analyzer{};
+    // Assignments not read so far that reach the current point, by name.
+    Definitions reaching{};
+    // The text of those assignments, as their statements are released.
+    std::map<uint64_t, std::string> pending{};
+    uint64_t next_position = 0;
+    // Found by the last call, in program order.
+    std::vector<std::string> unused{};
+    // Of the whole program so far, see ReducedPrecisionLine.
+    std::vector<std::string> reduced_precision{};
+
+    // Analyses the next top-level statement, given as a program of its own.
+    void Analyse(Program &p);
+
+    // Reports the assignments left unread at the end of the program.
+    void Finish();
+};
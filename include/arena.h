@@ -0,0 +1,70 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Bump-pointer allocator. Everything allocated in an arena is released at once
+// when the arena is destroyed or reset; destructors are never run, so only
+// objects without owning members may live here.
+class Arena {
+    constexpr static size_t kBlockSize = 64 * 1024;
+
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_{};
+    size_t current_block_ = 0;
+    std::byte* current_ = nullptr;
+    size_t left_ = 0;
+
+    void* AllocateSlow(size_t size, size_t align);
+
+public:
+    Arena() = default;
+
+    Arena(const Arena&) = delete;
+
+    Arena& operator=(const Arena&) = delete;
+
+    Arena(Arena&&) = default;
+
+    Arena& operator=(Arena&&) = default;
+
+    void* Allocate(size_t size, size_t align) {
+        void* ptr = current_;
+        if (std::align(align, size, ptr, left_) == nullptr) {
+            return AllocateSlow(size, align);
+        }
+        current_ = static_cast<std::byte*>(ptr) + size;
+        left_ -= size;
+        return ptr;
+    }
+
+    template<class T, class... Args>
+    T* New(Args&&... args) {
+        return new(Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template<class T>
+    std::span<T> NewArray(std::span<const T> items) {
+        if (items.empty()) {
+            return {};
+        }
+        auto* data = static_cast<T*>(Allocate(sizeof(T) * items.size(), alignof(T)));
+        std::uninitialized_copy(items.begin(), items.end(), data);
+        return {data, items.size()};
+    }
+
+    // Forgets every allocation but keeps the blocks for reuse.
+    void Reset();
+};
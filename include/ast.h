@@ -4,13 +4,33 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iosfwd>
-#include <map>
-#include <set>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "arena.h"
+#include "symbols.h"
+#include "varset.h"
 
 struct StatementVisitor;
+struct CompiledExpression;
+struct Assignment;
+
+struct Statement {
+    // Dense pre-order number assigned by the parser: the statements nested in
+    // this one are numbered id + 1, id + 2, ...
+    uint32_t id = 0;
+    // Summaries of the statement together with those nested in it, filled in
+    // by Summarize: the names read and written, each in increasing order, and
+    // the assignments in program order. The reads of an assignment are those
+    // of its expression, gathered by the parser.
+    std::span<const Symbol> reads{};
+    std::span<const Symbol> writes{};
+    std::span<Assignment*> assignments{};
 
-struct Statement : std::enable_shared_from_this<Statement> {
     virtual void Print(std::ostream &os) const = 0;
 
     virtual void Accept(StatementVisitor &visitor) = 0;
@@ -18,18 +38,36 @@ struct Statement : std::enable_shared_from_this<Statement> {
     virtual ~Statement() = default;
 };
 
-using StatementList = std::vector<std::shared_ptr<Statement>>;
+using StatementList = std::span<Statement*>;
 
 std::ostream &operator<<(std::ostream &os, const Statement &statement);
 
 std::ostream &operator<<(std::ostream &os, const StatementList &statement);
 
 struct Expression {
-    virtual void GetNames(std::set<char> &names) const = 0;
-
-    virtual std::shared_ptr<Expression> Evaluate(std::map<char, int> &variables) = 0;
-
-    virtual void Print(std::ostream &os) const = 0;
+    // Partial evaluation: substitutes the known variables, indexed by symbol,
+    // and folds constants, allocating new nodes in `arena`. Concrete
+    // evaluation goes through CompiledExpression instead.
+    virtual Expression* Evaluate(std::span<const std::optional<int>> variables, Arena &arena) = 0;
+
+    // The operands, left to right. Expressions are walked through these with
+    // an explicit stack rather than by recursion, so that their depth is only
+    // limited by memory.
+    virtual size_t OperandCount() const {
+        return 0;
+    }
+
+    virtual const Expression* Operand(size_t index) const {
+        return nullptr;
+    }
+
+    // Appends the instruction of the node itself and pushes its operands,
+    // left to right, onto `operands`: their code goes before that of the node.
+    virtual void Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const = 0;
+
+    // Prints the text before the operand `part`, or after the last operand
+    // when `part` is OperandCount().
+    virtual void Print(std::ostream &os, size_t part) const = 0;
 
     virtual ~Expression() = default;
 };
@@ -37,15 +75,18 @@ struct Expression {
 std::ostream &operator<<(std::ostream &os, const Expression &expression);
 
 struct Variable : Expression {
-    char name;
+    Symbol name;
+    // Kept by the symbol table of the program; a plain string rather than a
+    // view, to keep the node small.
+    const char* identifier;
 
-    explicit Variable(char name);
+    Variable(Symbol name, const char* identifier);
 
-    void GetNames(std::set<char> &names) const override;
+    Expression* Evaluate(std::span<const std::optional<int>> variables, Arena &arena) override;
 
-    std::shared_ptr<Expression> Evaluate(std::map<char, int> &variables) override;
+    void Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const override;
 
-    void Print(std::ostream &os) const override;
+    void Print(std::ostream &os, size_t part) const override;
 };
 
 struct Constant : Expression {
@@ -53,44 +94,52 @@ struct Constant : Expression {
 
     explicit Constant(int value);
 
-    void GetNames(std::set<char> &names) const override;
+    Expression* Evaluate(std::span<const std::optional<int>> variables, Arena &arena) override;
 
-    std::shared_ptr<Expression> Evaluate(std::map<char, int> &variables) override;
+    void Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const override;
 
-    void Print(std::ostream &os) const override;
+    void Print(std::ostream &os, size_t part) const override;
 };
 
 struct BinaryExpression : Expression {
-    std::shared_ptr<Expression> left;
-    std::shared_ptr<Expression> right;
+    Expression* left;
+    Expression* right;
     char operation;
 
-    BinaryExpression(std::shared_ptr<Expression> left, char operation, std::shared_ptr<Expression> right);
+    BinaryExpression(Expression* left, char operation, Expression* right);
 
-    void GetNames(std::set<char> &names) const override;
+    size_t OperandCount() const override;
 
-    std::shared_ptr<Expression> Evaluate(std::map<char, int> &variables) override;
+    const Expression* Operand(size_t index) const override;
 
-    void Print(std::ostream &os) const override;
+    Expression* Evaluate(std::span<const std::optional<int>> variables, Arena &arena) override;
+
+    void Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const override;
+
+    void Print(std::ostream &os, size_t part) const override;
 };
 
 struct PriorityExpression : Expression {
-    std::shared_ptr<Expression> expression;
+    Expression* expression;
 
-    explicit PriorityExpression(std::shared_ptr<Expression> expression);
+    explicit PriorityExpression(Expression* expression);
 
-    void GetNames(std::set<char> &names) const override;
+    size_t OperandCount() const override;
 
-    std::shared_ptr<Expression> Evaluate(std::map<char, int> &variables) override;
+    const Expression* Operand(size_t index) const override;
 
-    void Print(std::ostream &os) const override;
+    Expression* Evaluate(std::span<const std::optional<int>> variables, Arena &arena) override;
+
+    void Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const override;
+
+    void Print(std::ostream &os, size_t part) const override;
 };
 
 struct Assignment : Statement {
-    std::shared_ptr<Variable> variable;
-    std::shared_ptr<Expression> expression;
+    Variable* variable;
+    Expression* expression;
 
-    Assignment(std::shared_ptr<Variable> variable, std::shared_ptr<Expression> expression);
+    Assignment(Variable* variable, Expression* expression);
 
     void Print(std::ostream &os) const override;
 
@@ -98,10 +147,12 @@ struct Assignment : Statement {
 };
 
 struct IfStatement : Statement {
-    std::shared_ptr<Expression> condition;
-    std::shared_ptr<StatementList> body;
+    Expression* condition;
+    // Read by the condition, in increasing order.
+    std::span<const Symbol> condition_names{};
+    StatementList body;
 
-    IfStatement(std::shared_ptr<Expression> condition, std::shared_ptr<StatementList> body);
+    IfStatement(Expression* condition, StatementList body);
 
     void Print(std::ostream &os) const override;
 
@@ -109,22 +160,37 @@ struct IfStatement : Statement {
 };
 
 struct WhileStatement : Statement {
-    std::shared_ptr<Expression> condition;
-    std::shared_ptr<StatementList> body;
+    Expression* condition;
+    // Read by the condition, in increasing order.
+    std::span<const Symbol> condition_names{};
+    StatementList body;
 
-    WhileStatement(std::shared_ptr<Expression> condition, std::shared_ptr<StatementList> body);
+    WhileStatement(Expression* condition, StatementList body);
 
     void Print(std::ostream &os) const override;
 
     void Accept(StatementVisitor &visitor) override;
 };
 
+// Owns every node of the program: they all live in its arena and refer
+// to each other with plain pointers.
 struct Program {
-    std::shared_ptr<StatementList> statements;
-
-    explicit Program(std::shared_ptr<StatementList> statements);
+    Arena arena{};
+    // The names of the variables, which the nodes refer to.
+    std::shared_ptr<const SymbolTable> symbols{};
+    StatementList statements{};
+    uint32_t statement_count = 0;
+    // Every assignment in program order.
+    std::span<Assignment*> assignments{};
+
+    // Forgets every statement but keeps the memory of the arena, for parsing
+    // the next program into.
+    void Clear();
 };
 
+// Fills in the summaries of the statements of a freshly parsed program.
+void Summarize(Program &program);
+
 std::ostream &operator<<(std::ostream &os, const Program &program);
 
 struct StatementVisitor {
@@ -137,4 +203,32 @@ struct StatementVisitor {
     virtual void Visit(WhileStatement &while_statement) = 0;
 
     virtual ~StatementVisitor() = default;
+};
+
+// Visits statement lists without recursion: the lists being visited are kept
+// on an explicit stack, so that the nesting depth of a program is only limited
+// by memory. The visit of an if or while statement enters its body with
+// VisitBody, which returns at once; Leave is called once the body is done.
+class IterativeVisitor : public StatementVisitor {
+    struct Frame {
+        StatementList statements;
+        size_t next;
+        // The statement whose body this is, null for the list being visited.
+        Statement* owner;
+        bool is_loop;
+    };
+
+    std::vector<Frame> frames_{};
+
+protected:
+    void VisitBody(IfStatement &if_statement);
+
+    void VisitBody(WhileStatement &while_statement);
+
+    virtual void Leave(IfStatement &if_statement) {}
+
+    virtual void Leave(WhileStatement &while_statement) {}
+
+public:
+    void Visit(StatementList &sl) final;
 };
\ No newline at end of file
@@ -0,0 +1,34 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "ast.h"
+#include "result_cache.h"
+
+// Writes the report of one program. Returns false if the report was cut
+// short by a budget, which may depend on the load of the machine, so that
+// it is not cached.
+using ProgramAnalysis = std::function<bool(Program&, std::ostream&)>;
+
+// Turns the inputs into the list of files to analyse: directories are
+// walked recursively in sorted order, and "-" reads paths from stdin, one
+// per line.
+std::vector<std::string> ExpandInputs(const std::vector<std::string>& inputs);
+
+// Parses and analyses the files on `jobs` threads while the next files are
+// being opened and read ahead. The reports go to `out` in input order, each
+// preceded by a line with its path and timing. Reports found in `cache`, if
+// given, are not recomputed, and new complete ones are added to it. Returns false if
+// any file could not be analysed.
+bool RunBatch(const std::vector<std::string>& paths,
+              size_t jobs,
+              const ProgramAnalysis& analysis,
+              const ResultCache* cache,
+              std::ostream& out);
@@ -0,0 +1,59 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Limits on the work of analysing one file. Running out is sticky: the rest
+// of the file is then analysed in linear time, giving up precision where the
+// analysis would otherwise keep iterating.
+class Budget {
+public:
+    // Zero for no limit.
+    struct Limits {
+        double time_ms = 0;
+        uint64_t combinations = 0;
+        // Allocated for value states, see ValueState::AllocatedBytes.
+        uint64_t bytes = 0;
+    };
+
+private:
+    // The clock and the allocations are looked at once per this many calls
+    // to Spend.
+    constexpr static uint32_t kCheckPeriod = 256;
+
+    Limits limits_{};
+    std::chrono::steady_clock::time_point start_{};
+    uint64_t start_bytes_ = 0;
+    uint64_t combinations_ = 0;
+    uint32_t until_check_ = kCheckPeriod;
+    bool exhausted_ = false;
+
+    void Check();
+
+public:
+    Budget() = default;
+
+    explicit Budget(Limits limits);
+
+    // Starts over with the whole budget, e.g. for the next file.
+    void Restart();
+
+    // Counts the combinations of values an evaluation goes through.
+    void Spend(uint64_t combinations) {
+        combinations_ += combinations;
+        if (limits_.combinations != 0 && combinations_ > limits_.combinations) {
+            exhausted_ = true;
+        }
+        if (--until_check_ == 0) [[unlikely]] {
+            Check();
+        }
+    }
+
+    bool Exhausted() const {
+        return exhausted_;
+    }
+};
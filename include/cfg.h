@@ -0,0 +1,54 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ast.h"
+
+struct BasicBlock {
+    constexpr static uint32_t kNone = UINT32_MAX;
+
+    std::vector<Assignment*> assignments{};
+    // The if or while statement whose condition is checked at the end of the
+    // block, after its assignments; null for blocks that simply fall through.
+    Statement* branch = nullptr;
+    Expression* condition = nullptr;
+    // Read by the condition, in increasing order.
+    std::span<const Symbol> condition_names{};
+    // Loops are rotated: their condition is checked once on entry and once
+    // more at the end of the last block of the body, the latch.
+    bool is_latch = false;
+    // Targets of a branch, kNone for an edge that is known to be never taken.
+    uint32_t on_true = kNone;
+    uint32_t on_false = kNone;
+    std::vector<uint32_t> successors{};
+    std::vector<uint32_t> predecessors{};
+};
+
+// Control-flow graph of a statement list. Blocks are numbered in reverse
+// post-order, so every edge except the loop back edges goes from a lower
+// index to a higher one.
+struct Cfg {
+    std::vector<BasicBlock> blocks{};
+    uint32_t entry = 0;
+    uint32_t exit = 0;
+    // Statements whose bodies were left out of the graph because they are
+    // known to never happen.
+    std::vector<Statement*> pruned{};
+
+    // Both vectors are indexed by Statement::id and may be empty: branches
+    // that never happen lose their body, and those that always happen lose
+    // the edge skipping it.
+    static Cfg Build(StatementList statements,
+                     const std::vector<bool>& never_happens = {},
+                     const std::vector<bool>& always_happens = {});
+
+    static bool IsBackEdge(uint32_t from, uint32_t to) {
+        return to <= from;
+    }
+};
@@ -0,0 +1,91 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "symbols.h"
+#include "value_set.h"
+
+struct Expression;
+
+// Closed range of integers; the full range stands for an unknown value.
+struct Interval {
+    int lo = INT_MIN;
+    int hi = INT_MAX;
+
+    bool IsUnknown() const {
+        return lo == INT_MIN && hi == INT_MAX;
+    }
+
+    bool Contains(const Interval& other) const {
+        return lo <= other.lo && other.hi <= hi;
+    }
+
+    bool operator==(const Interval& other) const = default;
+};
+
+// Expression flattened into a postfix program, so that evaluating it for
+// concrete variable values is a tight loop without allocations.
+struct CompiledExpression {
+    // Batches are evaluated in whole SIMD registers, so their size has to be
+    // a multiple of this.
+    constexpr static size_t kLaneCount = 8;
+
+    enum class OpCode : uint8_t {
+        kConstant,
+        kVariable,
+        kAdd,
+        kSubtract,
+        kMultiply,
+        kDivide,
+        kLess,
+        kGreater,
+    };
+
+    struct Instruction {
+        OpCode op;
+        // Constant value, or position of the variable in `names`.
+        int operand = 0;
+    };
+
+    std::vector<Instruction> code{};
+    // Read by the expression, in increasing order. Kept by the caller, e.g.
+    // in the arena of the program for the expression of a statement.
+    std::span<const Symbol> names{};
+    size_t max_stack_size = 0;
+
+    CompiledExpression() = default;
+
+    // `names` must be exactly those the expression reads, in increasing
+    // order, and outlive the compiled code.
+    CompiledExpression(const Expression& expression, std::span<const Symbol> names);
+
+    void Emit(OpCode op, int operand = 0);
+
+    static OpCode BinaryOpCode(char operation);
+
+    // `variables` holds the values of the names, in the order of `names`;
+    // `stack` must hold at least max_stack_size values. Returns false if the result is undefined
+    // (division by zero or overflow of division).
+    bool Evaluate(const int* variables, int* stack, int& result) const;
+
+    // Evaluates `count` combinations at once, laid out as structure of arrays:
+    // `lanes[i]` points to `count` values of names[i].
+    // `stack` must hold max_stack_size * count values; the results are left
+    // in its first `count` values.
+    bool EvaluateBatch(const int* const* lanes, size_t count, int* stack) const;
+
+    // Interval arithmetic over the same program. `variables` is in the order
+    // of `names`, `stack` must hold at least max_stack_size ranges.
+    Interval EvaluateRange(const Interval* variables, Interval* stack) const;
+};
+
+// The distinct values among `results`, of which there are at most
+// ValueSet::kCapacity; reorders them.
+ValueSet DistinctValues(int* results, size_t count);
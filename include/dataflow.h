@@ -0,0 +1,131 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "cfg.h"
+
+enum class Direction {
+    kForward,
+    kBackward,
+};
+
+// A dataflow problem over a Cfg: a lattice of values, the transfer function of
+// a block and the join applied where control flow merges. `Join` returns
+// whether `into` changed; `back_edge` tells that the value comes along a loop
+// back edge, which is where widening belongs.
+template<class P>
+concept DataflowProblem = requires(P problem, const BasicBlock& block, typename P::Value value, bool back_edge) {
+    { P::kDirection } -> std::convertible_to<Direction>;
+    { problem.Bottom() } -> std::same_as<typename P::Value>;
+    { problem.Boundary() } -> std::same_as<typename P::Value>;
+    { problem.Transfer(block, value) } -> std::same_as<typename P::Value>;
+    { problem.Join(block, value, value, back_edge) } -> std::same_as<bool>;
+};
+
+// Optional refinements of a problem: forward problems may filter the value
+// leaving a block along each of its edges, e.g. by the branch condition,
+// problems that know part of the solution in advance may seed the input of
+// any block with a value below the fixpoint, and problems that widen may
+// narrow the solution afterwards.
+template<class P>
+concept HasEdgeTransfer = requires(P problem, const BasicBlock& block, uint32_t to, typename P::Value value) {
+    { problem.TransferEdge(block, to, value) } -> std::same_as<typename P::Value>;
+};
+
+template<class P>
+concept HasSeed = requires(P problem, uint32_t block) {
+    { problem.Seed(block) } -> std::same_as<typename P::Value>;
+};
+
+template<class P>
+concept HasNarrowing = requires(P problem, const BasicBlock& block, typename P::Value value) {
+    problem.Narrow(block, value, value);
+};
+
+template<DataflowProblem Problem>
+struct DataflowResult {
+    // Values at the start and at the end of every block, whichever direction
+    // the problem runs in.
+    std::vector<typename Problem::Value> before;
+    std::vector<typename Problem::Value> after;
+};
+
+// Worklist solver. Blocks are taken in reverse post-order (post-order for
+// backward problems), so that a loop-free graph is solved in a single pass
+// and loops are iterated innermost first.
+template<DataflowProblem Problem>
+DataflowResult<Problem> Solve(const Cfg& cfg, Problem& problem) {
+    constexpr bool kForward = Problem::kDirection == Direction::kForward;
+    const auto block_count = static_cast<uint32_t>(cfg.blocks.size());
+    DataflowResult<Problem> result{
+        std::vector(block_count, problem.Bottom()),
+        std::vector(block_count, problem.Bottom()),
+    };
+    auto& input = kForward ? result.before : result.after;
+    auto& output = kForward ? result.after : result.before;
+    input[kForward ? cfg.entry : cfg.exit] = problem.Boundary();
+    if constexpr (HasSeed<Problem>) {
+        for (uint32_t block = 0; block < block_count; ++block) {
+            problem.Join(cfg.blocks[block], input[block], problem.Seed(block), false);
+        }
+    }
+
+    const auto priority = [&](uint32_t block) {
+        return kForward ? block : block_count - 1 - block;
+    };
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> worklist;
+    std::vector<bool> queued(block_count, true);
+    for (uint32_t block = 0; block < block_count; ++block) {
+        worklist.push(priority(block));
+    }
+
+    // Computes the value the block hands over to `next`.
+    const auto outgoing = [&](uint32_t block, uint32_t next) {
+        if constexpr (kForward && HasEdgeTransfer<Problem>) {
+            return problem.TransferEdge(cfg.blocks[block], next, output[block]);
+        } else {
+            return output[block];
+        }
+    };
+
+    while (!worklist.empty()) {
+        const auto block = priority(worklist.top());
+        worklist.pop();
+        queued[block] = false;
+        output[block] = problem.Transfer(cfg.blocks[block], input[block]);
+        const auto& next_blocks = kForward ? cfg.blocks[block].successors : cfg.blocks[block].predecessors;
+        for (const auto next: next_blocks) {
+            const bool back_edge = kForward ? Cfg::IsBackEdge(block, next) : Cfg::IsBackEdge(next, block);
+            if (problem.Join(cfg.blocks[next], input[next], outgoing(block, next), back_edge) && !queued[next]) {
+                queued[next] = true;
+                worklist.push(priority(next));
+            }
+        }
+    }
+
+    if constexpr (HasNarrowing<Problem>) {
+        // One descending pass: recompute every input from its neighbours and
+        // let the problem narrow what widening overshot.
+        for (uint32_t i = 0; i < block_count; ++i) {
+            const auto block = priority(i);
+            const auto& previous_blocks = kForward ? cfg.blocks[block].predecessors : cfg.blocks[block].successors;
+            if (block == (kForward ? cfg.entry : cfg.exit)) {
+                continue;
+            }
+            auto value = problem.Bottom();
+            for (const auto previous: previous_blocks) {
+                problem.Join(cfg.blocks[block], value, outgoing(previous, block), false);
+            }
+            problem.Narrow(cfg.blocks[block], input[block], value);
+            output[block] = problem.Transfer(cfg.blocks[block], input[block]);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,20 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+struct Hash128 {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    bool operator==(const Hash128& other) const = default;
+};
+
+// Fast non-cryptographic hash of a byte string, mixing eight bytes at a time
+// into four independent lanes; it runs well ahead of reading the bytes from
+// disk.
+Hash128 HashBytes(std::string_view bytes, uint64_t seed = 0);
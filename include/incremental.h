@@ -0,0 +1,66 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "analysis.h"
+#include "parser.h"
+
+// Analyses successive versions of a program, such as an editor buffer after
+// every edit. Results are kept per top-level statement along with the values
+// before it and the names live after it; an update re-analyses the statements
+// whose tokens changed, then carries on forwards and backwards only as long as
+// the recomputed state differs from the one cached at the next boundary.
+// Served by the `buffer` requests of Server.
+class IncrementalAnalyser {
+    struct ForwardState {
+        PossibleValueAnalyzer::State values{};
+        bool reachable = true;
+
+        bool operator==(const ForwardState& other) const = default;
+    };
+
+    struct Entry {
+        TopLevelStatement top_level{};
+        ForwardState before{};
+        // Facts and unused assignments, as statement ids local to the entry.
+        std::vector<uint32_t> never_happens{};
+        std::vector<uint32_t> always_happens{};
+        std::vector<uint32_t> unused{};
+        VarSet live_after{};
+        VarSet live_before{};
+    };
+
+    // Shared by every version, so that the cached states and sets number the
+    // variables alike.
+    std::shared_ptr<SymbolTable> symbols_ = std::make_shared<SymbolTable>();
+    std::unique_ptr<Program> program_{};
+    std::vector<Entry> entries_{};
+    // The values after the last statement.
+    ForwardState end_{};
+    PossibleValueAnalyzer possible_value_analyzer_{};
+
+    void AnalyseForward(Entry& entry, ForwardState& state);
+
+    void AnalyseBackward(Entry& entry, VarSet& live);
+
+public:
+    struct UpdateStats {
+        // Top-level statements analysed again by each pass.
+        size_t forward = 0;
+        size_t backward = 0;
+    };
+
+    explicit IncrementalAnalyser(ValueDomain domain = ValueDomain::kValueSet);
+
+    // Replaces the program with a new version of its source.
+    UpdateStats Update(std::string_view source);
+
+    // The unused assignments of the current version, in program order.
+    std::vector<Statement*> Unused() const;
+};
@@ -4,12 +4,63 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
 #include "ast.h"
 #include "tokens.h"
 
+struct TopLevelStatement {
+    Statement* statement;
+    uint32_t statement_count;
+    // The tokens of the statement, each encoded as a number, and their hash,
+    // to tell which statements changed between two versions of a program.
+    // Variables are encoded by their symbol, so versions must share the
+    // symbol table.
+    uint64_t hash;
+    std::vector<uint64_t> tokens;
+
+    bool SameTokens(const TopLevelStatement& other) const {
+        return hash == other.hash && tokens == other.tokens;
+    }
+};
+
 class Parser {
-    std::istream& in_;
+    // An if or while statement whose body is being parsed.
+    struct OpenBlock {
+        bool is_loop;
+        uint32_t id;
+        Expression* condition;
+        std::span<const Symbol> condition_names;
+        // Index in parsed_ of the first statement of the body.
+        size_t first;
+    };
+
+    // An expression waiting for the operand being parsed: the left-hand side
+    // of a binary operator, or an opening parenthesis when `op` is 0.
+    struct OpenOperand {
+        Expression* left;
+        char op;
+        int min_precedence;
+    };
+
+    std::string_view source_;
     std::optional<Token> current_token_;
+    std::shared_ptr<SymbolTable> symbols_;
+    std::unique_ptr<Program> program_;
+    uint32_t next_statement_id_ = 0;
+    bool streaming_ = false;
+    bool hash_tokens_ = false;
+    uint64_t token_hash_ = 0;
+    std::vector<uint64_t> tokens_{};
+    // Explicit stacks, so that nesting is only limited by memory.
+    std::vector<OpenBlock> open_blocks_{};
+    std::vector<Statement*> parsed_{};
+    std::vector<OpenOperand> open_operands_{};
+    // The names read by the expression being parsed.
+    std::vector<Symbol> expression_names_{};
 
     template<class TokenType>
     bool Peek(TokenType& t) {
@@ -44,17 +95,40 @@ class Parser {
     }
 
     void NextToken() {
-        current_token_ = ::NextToken(in_);
+        if (hash_tokens_ && current_token_.has_value()) {
+            HashToken(*current_token_);
+        }
+        current_token_ = ::NextToken(source_);
     }
 
+    void HashToken(const Token& token);
+
 public:
-    explicit Parser(std::istream& in);
+    // Parsers given the same symbol table number the variables alike, e.g.
+    // for successive versions of a program. A program given back from an
+    // earlier parse is cleared and parsed into, reusing its memory.
+    explicit Parser(std::string_view source,
+                    std::shared_ptr<SymbolTable> symbols = nullptr,
+                    std::unique_ptr<Program> program = nullptr);
+
+    std::unique_ptr<Program> ParseProgram();
+
+    // Parses the whole program like ParseProgram, but numbers the statements
+    // of every top-level statement from 0, as a program of its own would be,
+    // and describes the top-level statements in `top_level`. The statement
+    // count of the program is then that of its largest top-level statement.
+    std::unique_ptr<Program> ParseProgram(std::vector<TopLevelStatement>& top_level);
 
-    std::shared_ptr<Program> ParseProgram();
+    // Streaming: parses the next top-level statement as a program of its own,
+    // with its statements numbered from 0, releasing the previous one.
+    // Returns null at the end of the input.
+    Program* ParseNextStatement();
 
-    std::shared_ptr<StatementList> ParseStatementList();
+    StatementList ParseStatementList();
 
-    std::shared_ptr<Statement> ParseStatement();
+    Statement* ParseStatement();
 
-    std::shared_ptr<Expression> ParseExpression(int min_precedence = 0);
+    // Also gives the names the expression reads, in increasing order. Throws
+    // if no expression starts at the current token.
+    Expression* ParseExpression(std::span<const Symbol>& names, int min_precedence = 0);
 };
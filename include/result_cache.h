@@ -0,0 +1,37 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// On-disk cache of analysis reports, addressed by the hash of the source
+// together with the configuration of the analysis. Entries are written to a
+// temporary file and renamed into place, so that concurrent runs sharing the
+// directory only ever see complete entries; a damaged entry reads as a miss.
+// kFormatVersion covers the layout of the entries; what the reports mean is
+// up to the configuration, which should name the version of the analysis.
+class ResultCache {
+    constexpr static uint32_t kFormatVersion = 2;
+
+    std::filesystem::path directory_;
+    uint64_t configuration_hash_;
+
+    std::filesystem::path PathOf(std::string_view source) const;
+
+public:
+    // `configuration` spells out everything besides the source that the
+    // reports depend on.
+    ResultCache(std::filesystem::path directory, std::string_view configuration);
+
+    std::optional<std::string> Load(std::string_view source) const;
+
+    // `report` is a sequence of newline-terminated lines. Best effort: an
+    // entry that cannot be written is simply not cached.
+    void Store(std::string_view source, std::string_view report) const;
+};
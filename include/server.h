@@ -0,0 +1,63 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "analysis.h"
+#include "incremental.h"
+#include "thread_pool.h"
+
+// Answers requests to analyse programs for as long as it runs, so that
+// clients such as editors do not start a process per file. The worker
+// threads are kept, and each one keeps its analyser and the memory of its
+// last program for the next request.
+//
+// A client sends requests as lines and gets the responses in order:
+//   file <path>       analyses the file
+//   source <length>   analyses the <length> bytes following the line
+//   buffer <length>   analyses them as the next version of the buffer the
+//                     client edits, re-analysing only what the edit affects
+// A response is `ok <count>` followed by that many lines, the report of the
+// program as for a single file, or a single `error <message>` line. A source
+// longer than kMaxSourceLength is skipped and answered with an error.
+// Buffers are not budgeted, and a version that fails to parse leaves the
+// last one in place.
+class Server {
+public:
+    constexpr static size_t kMaxSourceLength = size_t{1} << 30;
+
+private:
+    ValueDomain domain_;
+    Budget::Limits budget_;
+    ThreadPool pool_;
+    // ThreadPool::Submit is called by every client.
+    std::mutex submit_mutex_;
+
+    // Runs on a worker.
+    std::string Analyse(std::string_view source);
+
+    // Runs on a worker.
+    std::string Update(IncrementalAnalyser& buffer, std::string_view source);
+
+    // Runs the task on a worker and waits for its response.
+    std::string OnWorker(std::function<std::string()> task);
+
+public:
+    Server(ValueDomain domain, Budget::Limits budget, size_t jobs);
+
+    // Serves the requests of a single client until the end of its input.
+    void Serve(std::istream& in, std::ostream& out);
+
+    // Serves every client connecting to a Unix domain socket created at
+    // `path`, each one on a thread of its own, until the process ends.
+    // Throws if the socket cannot be set up or stops accepting clients, once
+    // the connected ones are done.
+    void Listen(const std::string& path);
+};
@@ -0,0 +1,33 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Read-only contents of a source file. The file is memory-mapped where the
+// platform allows it and read into memory otherwise.
+class SourceFile {
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string buffer_{};
+
+public:
+    explicit SourceFile(const std::string& path);
+
+    SourceFile(const SourceFile&) = delete;
+
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    ~SourceFile();
+
+    // Asks the system to start reading the whole file in the background.
+    void Prefetch() const;
+
+    std::string_view Text() const {
+        return {data_, size_};
+    }
+};
@@ -0,0 +1,121 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "cfg.h"
+
+// A value of the static single assignment form: every one is defined exactly
+// once, by an assignment, by a phi where control flow joins, or on entry for
+// the names read before any assignment.
+struct SsaValue {
+    enum class Kind : uint8_t {
+        kEntry,
+        kAssignment,
+        kPhi,
+    };
+
+    Kind kind;
+    Symbol name;
+    uint32_t block;
+    Assignment* assignment = nullptr;
+    // Position of the operands in Ssa::operands.
+    uint32_t first_operand = 0;
+    uint32_t operand_count = 0;
+};
+
+// Static single assignment form of a control-flow graph, with phis placed on
+// the iterated dominance frontiers of the assignments to each name. Lists
+// are kept flat, each one a range of a shared vector given by offsets.
+struct Ssa {
+    std::vector<SsaValue> values{};
+    // Of an assignment, the values of the names its expression reads, in the
+    // order of Statement::reads; of a phi, the value coming along each edge
+    // into its block, in the order of the predecessors.
+    std::vector<uint32_t> operands{};
+    // Indexed by block: its immediate dominator, kNone for the entry.
+    std::vector<uint32_t> dominators{};
+    // Indexed by block: its phis followed by its assignments, in order.
+    std::vector<uint32_t> definition_offsets{};
+    std::vector<uint32_t> definitions{};
+    // Indexed by block: the values of the names its condition reads, in the
+    // order of BasicBlock::condition_names.
+    std::vector<uint32_t> condition_offsets{};
+    std::vector<uint32_t> condition_operands{};
+    // Def-use chains, indexed by value: the values having it among their
+    // operands, and the blocks whose condition reads it.
+    std::vector<uint32_t> user_offsets{};
+    std::vector<uint32_t> users{};
+    std::vector<uint32_t> branch_offsets{};
+    std::vector<uint32_t> branches{};
+
+    static Ssa Build(const Cfg& cfg);
+
+    std::span<const uint32_t> Operands(uint32_t value) const {
+        const auto& definition = values[value];
+        return {operands.data() + definition.first_operand, definition.operand_count};
+    }
+
+    std::span<const uint32_t> Definitions(uint32_t block) const {
+        return Range(definition_offsets, definitions, block);
+    }
+
+    std::span<const uint32_t> ConditionOperands(uint32_t block) const {
+        return Range(condition_offsets, condition_operands, block);
+    }
+
+    std::span<const uint32_t> Users(uint32_t value) const {
+        return Range(user_offsets, users, value);
+    }
+
+    std::span<const uint32_t> Branches(uint32_t value) const {
+        return Range(branch_offsets, branches, value);
+    }
+
+private:
+    static std::span<const uint32_t> Range(const std::vector<uint32_t>& offsets,
+                                           const std::vector<uint32_t>& items,
+                                           uint32_t index) {
+        return {items.data() + offsets[index], items.data() + offsets[index + 1]};
+    }
+};
+
+// Sparse conditional constant propagation: values are undefined until an
+// executable definition gives them one, constant while every executable
+// definition agrees, and overdefined beyond that. Only edges found executable
+// carry values, so branches on constants cut off the code they skip.
+struct SparseConstants {
+    struct Lattice {
+        enum class Kind : uint8_t {
+            kUndefined,
+            kConstant,
+            kOverdefined,
+        };
+
+        Kind kind = Kind::kUndefined;
+        int value = 0;
+
+        bool operator==(const Lattice& other) const = default;
+    };
+
+    // Indexed like Ssa::values.
+    std::vector<Lattice> values{};
+    std::vector<bool> executable_blocks{};
+    // The edges into each block, in the order of its predecessors, start at
+    // its offset.
+    std::vector<uint32_t> edge_offsets{};
+    std::vector<bool> executable_edges{};
+
+    static SparseConstants Propagate(const Cfg& cfg, const Ssa& ssa);
+
+    bool IsExecutable(uint32_t block, size_t predecessor) const {
+        return executable_edges[edge_offsets[block] + predecessor];
+    }
+
+    bool IsExecutable(const Cfg& cfg, uint32_t from, uint32_t to) const;
+};
@@ -0,0 +1,80 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+// Counters of where the analyses spend their time. They are collected into
+// the statistics of the current thread, which are null unless asked for, so
+// that counting costs a single test otherwise.
+struct Statistics {
+    uint64_t expression_evaluations = 0;
+    uint64_t combinations_evaluated = 0;
+    // Expressions left unevaluated because their operands have more than
+    // kMaxCombinationCount combinations of values.
+    uint64_t combination_limit_hits = 0;
+    // Value sets given up after a join made them larger than that.
+    uint64_t value_set_limit_hits = 0;
+    uint64_t max_loop_depth = 0;
+    uint64_t loop_depth_limit_hits = 0;
+    // Loops summarised in closed form rather than unrolled.
+    uint64_t loop_summaries = 0;
+    // Loops left as soon as an iteration changed nothing.
+    uint64_t loop_fixpoints = 0;
+    // Nested loops whose result was reused from an earlier visit.
+    uint64_t loop_exit_reuses = 0;
+    // Loops given up on, or widened early, once the budget of the file ran
+    // out.
+    uint64_t budget_cutoffs = 0;
+    uint64_t state_copies = 0;
+    double parse_ms = 0;
+    double possible_values_ms = 0;
+    double live_variables_ms = 0;
+    double ssa_ms = 0;
+
+    static constinit thread_local Statistics* current;
+
+    static void Add(uint64_t Statistics::* counter, uint64_t amount = 1) {
+        if (current != nullptr) [[unlikely]] {
+            current->*counter += amount;
+        }
+    }
+
+    static void Max(uint64_t Statistics::* counter, uint64_t value) {
+        if (current != nullptr && current->*counter < value) [[unlikely]] {
+            current->*counter = value;
+        }
+    }
+
+    // Adds the wall time of its scope to a phase.
+    class Timer {
+        double Statistics::* phase_;
+        std::chrono::steady_clock::time_point start_{};
+
+    public:
+        explicit Timer(double Statistics::* phase) : phase_(phase) {
+            if (current != nullptr) [[unlikely]] {
+                start_ = std::chrono::steady_clock::now();
+            }
+        }
+
+        Timer(const Timer&) = delete;
+
+        Timer& operator=(const Timer&) = delete;
+
+        ~Timer() {
+            if (current != nullptr) [[unlikely]] {
+                current->*phase_ += std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start_).count();
+            }
+        }
+    };
+
+    void Merge(const Statistics& other);
+
+    void WriteJson(std::ostream& out) const;
+};
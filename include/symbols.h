@@ -0,0 +1,59 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Dense number of a variable, given in the order the names are first seen.
+using Symbol = uint32_t;
+
+// Interns the names of the variables, so that they are told apart by the whole
+// identifier but stored as symbols that index flat arrays.
+class SymbolTable {
+    constexpr static Symbol kNone = UINT32_MAX;
+
+    // A deque, so that the names keep their place as more are added.
+    std::deque<std::string> names_{};
+    std::unordered_map<std::string_view, Symbol> symbols_{};
+    // The names of a single character, the most common, skip the hash map.
+    std::array<Symbol, 128> single_{};
+
+    Symbol InternSlow(std::string_view name);
+
+public:
+    SymbolTable() {
+        single_.fill(kNone);
+    }
+
+    Symbol Intern(std::string_view name) {
+        if (name.size() == 1 && static_cast<unsigned char>(name[0]) < single_.size()) {
+            auto& symbol = single_[static_cast<unsigned char>(name[0])];
+            if (symbol == kNone) {
+                symbol = InternSlow(name);
+            }
+            return symbol;
+        }
+        return InternSlow(name);
+    }
+
+    // Valid as long as the table.
+    const std::string& Name(Symbol symbol) const {
+        return names_[symbol];
+    }
+
+    size_t size() const {
+        return names_.size();
+    }
+
+    // Forgets every name, so that the next program is numbered from zero
+    // again.
+    void Clear();
+};
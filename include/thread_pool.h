@@ -0,0 +1,54 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with a queue of its own. Tasks are
+// spread over the queues round-robin; a worker runs its own tasks in FIFO
+// order and steals from the back of the others' queues when it runs dry.
+class ThreadPool {
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_{};
+    std::vector<std::thread> threads_{};
+    size_t next_queue_ = 0;
+    // Tasks submitted but not yet claimed by a worker.
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    size_t pending_ = 0;
+    bool stopping_ = false;
+
+    void Run(size_t index);
+
+    std::optional<std::function<void()>> Take(size_t index);
+
+public:
+    explicit ThreadPool(size_t thread_count);
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Runs the tasks still queued, then joins the workers.
+    ~ThreadPool();
+
+    size_t Size() const {
+        return threads_.size();
+    }
+
+    // Must only be called from one thread at a time.
+    void Submit(std::function<void()> task);
+};
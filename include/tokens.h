@@ -4,15 +4,17 @@
 
 #pragma once
 
-#include <iosfwd>
-#include <string>
+#include <optional>
+#include <string_view>
+#include <variant>
 
 struct ConstantToken {
     int value = 0;
 };
 
 struct NameToken {
-    char name = 'X';
+    // The whole identifier, within the source.
+    std::string_view name{};
 };
 
 struct OperatorToken {
@@ -38,4 +40,6 @@ using Token = std::variant<
         WhileToken,
         EndToken>;
 
-std::optional<Token> NextToken(std::istream &in_);
+// Lexes the token at the front of `source` and advances past it.
+// Returns nothing at the end of input or on an unexpected character.
+std::optional<Token> NextToken(std::string_view &source);
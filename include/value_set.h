@@ -0,0 +1,86 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Set of at most kCapacity integers stored inline: as a bitmap while the
+// values lie within 64 consecutive integers, and as a sorted array otherwise.
+// Every set has a single representation, so sets compare bitwise.
+class ValueSet {
+public:
+    constexpr static size_t kCapacity = 32;
+
+private:
+    constexpr static int64_t kBitmapSpan = 64;
+
+    uint8_t size_ = 0;
+    bool bitmap_ = false;
+    // Bitmap: the smallest value, which bit 0 stands for.
+    int base_ = 0;
+    union {
+        uint64_t bits_ = 0;
+        int values_[kCapacity];
+    };
+
+    static ValueSet Bitmap(int base, uint64_t bits);
+
+public:
+    // `values` must be sorted, distinct and at most kCapacity.
+    static ValueSet FromSorted(const int* values, size_t count);
+
+    static ValueSet Single(int value);
+
+    // All the integers from lo to hi, which must be fewer than kCapacity.
+    static ValueSet Consecutive(int lo, int hi);
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    int min() const {
+        return bitmap_ ? base_ : values_[0];
+    }
+
+    int max() const {
+        return bitmap_ ? base_ + 63 - std::countl_zero(bits_) : values_[size_ - 1];
+    }
+
+    bool contains(int value) const;
+
+    // Calls `f` with every value in increasing order.
+    template<class F>
+    void ForEach(F&& f) const {
+        if (!bitmap_) {
+            for (size_t i = 0; i < size_; ++i) {
+                f(values_[i]);
+            }
+            return;
+        }
+        for (auto bits = bits_; bits != 0; bits &= bits - 1) {
+            f(base_ + std::countr_zero(bits));
+        }
+    }
+
+    // Adds the values of `other`, unless there would be more than kCapacity
+    // of them; returns whether it did.
+    bool Merge(const ValueSet& other);
+
+    // Removes the values outside [lo, hi] and returns whether any are left.
+    bool EraseOutside(int64_t lo, int64_t hi);
+
+    bool Includes(const ValueSet& other) const;
+
+    // Equal for equal sets.
+    uint64_t Hash() const;
+
+    bool operator==(const ValueSet& other) const;
+};
@@ -0,0 +1,120 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "compiled_expression.h"
+#include "value_set.h"
+#include "varset.h"
+
+// What is known about each variable, in a table indexed by symbol and split
+// into pages. Copies share the table until one of them changes, so a copy
+// costs a single reference. The first change after it copies the table with
+// its first page, which holds the first symbols, and the first change to a
+// later page copies that page only, so that changes cost the same however
+// many variables the program has.
+// A variable is unset until read or written, as with std::map::operator[].
+class ValueState {
+public:
+    enum class Kind : uint8_t {
+        kUnset,
+        kUnknown,
+        // Exactly one of the values.
+        kValues,
+        // Interval domain: somewhere in the range.
+        kRange,
+    };
+
+private:
+    struct Slot {
+        Kind kind = Kind::kUnset;
+        Interval range{};
+        ValueSet values{};
+    };
+
+    constexpr static size_t kPageSize = 32;
+
+    struct Page {
+        std::array<Slot, kPageSize> slots{};
+        // Of the last change of each slot, unique in the process: slots of two
+        // states with the same stamp hold the same. 0 for a slot never set.
+        std::array<uint64_t, kPageSize> stamps{};
+    };
+
+    struct Table {
+        Page first{};
+        // The pages from the second on; null for those without a set
+        // variable.
+        std::vector<std::shared_ptr<Page>> rest{};
+        VarSet names{};
+    };
+
+    std::shared_ptr<Table> table_{};
+
+    const Page* PageOf(Symbol name) const;
+
+    // Null if the name is unset.
+    const Slot* Read(Symbol name) const;
+
+    uint64_t StampOf(Symbol name) const;
+
+    // The page of the name, after making it unshared.
+    Page& PageFor(Symbol name);
+
+    Slot& Write(Symbol name);
+
+public:
+    Kind KindOf(Symbol name) const;
+
+    // The values of the name, empty unless exactly known, after making it
+    // set.
+    const ValueSet& Get(Symbol name);
+
+    // The values of the name, or null if it is not set.
+    const ValueSet* Find(Symbol name) const;
+
+    // The exact values or the range of the name.
+    Interval RangeOf(Symbol name) const;
+
+    // The exact values of the name for changing them in place.
+    ValueSet& Modify(Symbol name);
+
+    // No values stand for an unknown value.
+    void Set(Symbol name, const ValueSet& values);
+
+    // Exact values are kept for ranges narrower than `max_values`.
+    void SetRange(Symbol name, Interval range, size_t max_values);
+
+    void SetUnknown(Symbol name);
+
+    // Gives the name what it has in `other`.
+    void Share(Symbol name, const ValueState& other);
+
+    void Clear();
+
+    VarSet Names() const;
+
+    // Whether the name still holds what it holds in `other`, which is the
+    // case when neither has changed it since one was copied from the other.
+    // Told by the table, the page or the stamp of the slot alone, without
+    // comparing contents. This holds whichever threads built the two states,
+    // as every change takes a stamp from one process-wide counter.
+    bool SharesValues(const ValueState& other, Symbol name) const;
+
+    // Whether the names hold the same here and in `other`, set or not.
+    bool HoldsSame(const ValueState& other, const VarSet& names) const;
+
+    // Of what the names hold, equal whenever HoldsSame is.
+    uint64_t Hash(const VarSet& names) const;
+
+    bool operator==(const ValueState& other) const;
+
+    // Bytes allocated so far for the tables and pages of the states of this
+    // thread, copies included.
+    static uint64_t AllocatedBytes();
+};
@@ -0,0 +1,177 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "symbols.h"
+
+// Set of variables as a bitset indexed by symbol, so that copying, merging and
+// erasing are bit operations on words. The first 64 symbols are kept inline,
+// and the set only allocates for symbols beyond them, growing to the largest
+// one inserted.
+class VarSet {
+    constexpr static size_t kWordBits = 64;
+
+    uint64_t first_ = 0;
+    // The words of the symbols from kWordBits on; may end in zero words.
+    std::vector<uint64_t> rest_{};
+
+    size_t WordCount() const {
+        return 1 + rest_.size();
+    }
+
+    uint64_t Word(size_t index) const {
+        if (index == 0) {
+            return first_;
+        }
+        return index <= rest_.size() ? rest_[index - 1] : 0;
+    }
+
+    uint64_t& WordFor(Symbol name) {
+        const size_t index = name / kWordBits;
+        if (index == 0) {
+            return first_;
+        }
+        if (index > rest_.size()) {
+            rest_.resize(index, 0);
+        }
+        return rest_[index - 1];
+    }
+
+    static uint64_t Bit(Symbol name) {
+        return uint64_t{1} << (name % kWordBits);
+    }
+
+public:
+    class iterator {
+        const VarSet* set_;
+        size_t word_;
+        uint64_t bits_;
+
+        void SkipEmptyWords() {
+            while (bits_ == 0 && word_ + 1 < set_->WordCount()) {
+                bits_ = set_->Word(++word_);
+            }
+            if (bits_ == 0) {
+                word_ = set_->WordCount();
+            }
+        }
+
+    public:
+        iterator(const VarSet* set, size_t word) : set_(set), word_(word), bits_(set->Word(word)) {
+            SkipEmptyWords();
+        }
+
+        Symbol operator*() const {
+            return static_cast<Symbol>(word_ * kWordBits + std::countr_zero(bits_));
+        }
+
+        iterator& operator++() {
+            bits_ &= bits_ - 1;
+            SkipEmptyWords();
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const {
+            return word_ == other.word_ && bits_ == other.bits_;
+        }
+    };
+
+    void insert(Symbol name) {
+        if (name < kWordBits) {
+            first_ |= Bit(name);
+            return;
+        }
+        WordFor(name) |= Bit(name);
+    }
+
+    void insert_range(std::span<const Symbol> names) {
+        for (const auto name: names) {
+            insert(name);
+        }
+    }
+
+    size_t erase(Symbol name) {
+        if (name < kWordBits) {
+            const bool present = (first_ & Bit(name)) != 0;
+            first_ &= ~Bit(name);
+            return present;
+        }
+        if (!contains(name)) {
+            return 0;
+        }
+        WordFor(name) &= ~Bit(name);
+        return 1;
+    }
+
+    bool contains(Symbol name) const {
+        if (name < kWordBits) {
+            return (first_ & Bit(name)) != 0;
+        }
+        return (Word(name / kWordBits) & Bit(name)) != 0;
+    }
+
+    void merge(const VarSet& other) {
+        first_ |= other.first_;
+        if (rest_.size() < other.rest_.size()) {
+            rest_.resize(other.rest_.size(), 0);
+        }
+        for (size_t i = 0; i < other.rest_.size(); ++i) {
+            rest_[i] |= other.rest_[i];
+        }
+    }
+
+    // Erases the names of `other`.
+    void subtract(const VarSet& other) {
+        first_ &= ~other.first_;
+        for (size_t i = 0; i < std::min(rest_.size(), other.rest_.size()); ++i) {
+            rest_[i] &= ~other.rest_[i];
+        }
+    }
+
+    // Erases the names not in `other`.
+    void intersect(const VarSet& other) {
+        first_ &= other.first_;
+        for (size_t i = 0; i < rest_.size(); ++i) {
+            rest_[i] &= i < other.rest_.size() ? other.rest_[i] : 0;
+        }
+    }
+
+    bool empty() const {
+        return first_ == 0 && std::ranges::all_of(rest_, [](uint64_t word) { return word == 0; });
+    }
+
+    size_t size() const {
+        size_t count = std::popcount(first_);
+        for (const auto word: rest_) {
+            count += std::popcount(word);
+        }
+        return count;
+    }
+
+    iterator begin() const {
+        return iterator{this, 0};
+    }
+
+    iterator end() const {
+        return iterator{this, WordCount()};
+    }
+
+    bool operator==(const VarSet& other) const {
+        const auto word_count = std::max(WordCount(), other.WordCount());
+        for (size_t i = 0; i < word_count; ++i) {
+            if (Word(i) != other.Word(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -2,290 +2,1193 @@
 // Created by Aleksandr Govenko on 17/12/2023.
 //
 
+#include <algorithm>
+#include <array>
+#include <optional>
 #include <ranges>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include "analysis.h"
+#include "dataflow.h"
+#include "statistics.h"
 
-void LiveVariableAnalyser::Analyse(Program& p) {
-    Visit(*p.statements);
-}
+namespace {
+
+// The effect of running from the start of a block to some later point: the
+// names read before being written on some path, and those written on every
+// path.
+struct LivenessSummary {
+    VarSet uses;
+    VarSet writes;
 
-void LiveVariableAnalyser::Visit(StatementList& sl) {
-    for (const auto& stmt: sl | std::views::reverse) {
-        stmt->Accept(*this);
+    // From the names live at the later point, those live at the start.
+    void Apply(VarSet& live) const {
+        live.subtract(writes);
+        live.merge(uses);
     }
-}
+};
 
-void LiveVariableAnalyser::Visit(Assignment& stmt) {
-    const char write_name = stmt.variable->name;
-    if (live_in_succ.erase(write_name) == 0) {
-        unused.push_back(stmt.shared_from_this());
+void ReadCondition(const BasicBlock& block, VarSet& live) {
+    // The condition of a loop counts as read on entry only, not at the end of
+    // each iteration.
+    if (block.condition != nullptr && !block.is_latch) {
+        live.insert_range(block.condition_names);
     }
-    stmt.expression->GetNames(live_in_succ);
 }
 
-void LiveVariableAnalyser::Visit(IfStatement& stmt) {
-    std::set<char> original_live_in_succ = live_in_succ;
-    Visit(*stmt.body);
-    live_in_succ.merge(original_live_in_succ);
-    stmt.condition->GetNames(live_in_succ);
+// Summarises every block up to its end, in a single pass over the
+// assignments, so that the rest of the analysis works a block at a time.
+std::vector<LivenessSummary> BlockSummaries(const Cfg& cfg) {
+    std::vector<LivenessSummary> summaries(cfg.blocks.size());
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        const auto& block = cfg.blocks[i];
+        auto& summary = summaries[i];
+        ReadCondition(block, summary.uses);
+        for (const auto* assignment: block.assignments | std::views::reverse) {
+            summary.uses.erase(assignment->variable->name);
+            summary.uses.insert_range(assignment->reads);
+            summary.writes.insert(assignment->variable->name);
+        }
+    }
+    return summaries;
 }
 
-void LiveVariableAnalyser::Visit(WhileStatement& stmt) {
-    std::set<char> original_live_in_succ = live_in_succ;
-    const auto previous_size = unused.size();
+struct LivenessProblem {
+    using Value = VarSet;
+    constexpr static Direction kDirection = Direction::kBackward;
 
-    Visit(*stmt.body);
-    unused.resize(previous_size);
-    live_in_succ.insert(original_live_in_succ.begin(), original_live_in_succ.end());
-    Visit(*stmt.body);
+    const Cfg& cfg;
+    // Indexed by block, see BlockSummaries.
+    const std::vector<LivenessSummary>& blocks;
+    // Indexed by block: the names live at the end of each latch on account of
+    // the next iteration, see LoopUses.
+    std::vector<VarSet> seeds{};
+    VarSet live_out{};
 
-    live_in_succ.merge(original_live_in_succ);
-    stmt.condition->GetNames(live_in_succ);
-}
+    VarSet Bottom() const {
+        return {};
+    }
+
+    VarSet Boundary() const {
+        return live_out;
+    }
+
+    VarSet Transfer(const BasicBlock& block, VarSet live) const {
+        blocks[&block - cfg.blocks.data()].Apply(live);
+        return live;
+    }
+
+    bool Join(const BasicBlock&, VarSet& into, const VarSet& value, bool) const {
+        const auto previous = into;
+        into.merge(value);
+        return into != previous;
+    }
+
+    VarSet Seed(uint32_t block) const {
+        return seeds[block];
+    }
+};
+
+// Computes, for every latch, the names read before being written in an
+// iteration of its loop. The solution at the end of the latch is exactly
+// these plus the names live after the loop, so with them seeded the solver
+// settles every block in a single pass, however deeply the loops nest.
+std::vector<VarSet> LoopUses(const Cfg& cfg, const std::vector<LivenessSummary>& blocks) {
+    const auto block_count = static_cast<uint32_t>(cfg.blocks.size());
+    std::vector<uint32_t> latch_of(block_count, BasicBlock::kNone);
+    for (uint32_t i = 0; i < block_count; ++i) {
+        if (cfg.blocks[i].is_latch) {
+            latch_of[cfg.blocks[i].on_true] = i;
+        }
+    }
 
-void WriteNamesCollector::Visit(StatementList& sl) {
-    for (const auto& stmt: sl) {
-        stmt->Accept(*this);
+    // Loop bodies are contiguous ranges of blocks ending in their latch and
+    // followed by the loop exit, so a single backward sweep sees every block
+    // after its successors. `within` summarises a block up to the end of the
+    // current iteration of the innermost loop around it, and `entered` a
+    // whole loop for a block that enters it, taken at its first body block.
+    std::vector<LivenessSummary> within(block_count);
+    std::vector<LivenessSummary> entered(block_count);
+    std::vector<VarSet> seeds(block_count);
+    for (uint32_t i = block_count; i-- > 0;) {
+        const auto& block = cfg.blocks[i];
+        auto& summary = within[i];
+        if (!block.is_latch) {
+            bool first = true;
+            for (const auto next: block.successors) {
+                const auto& next_summary = latch_of[next] != BasicBlock::kNone ? entered[next] : within[next];
+                summary.uses.merge(next_summary.uses);
+                if (first) {
+                    summary.writes = next_summary.writes;
+                    first = false;
+                } else {
+                    summary.writes.intersect(next_summary.writes);
+                }
+            }
+        }
+        blocks[i].Apply(summary.uses);
+        summary.writes.merge(blocks[i].writes);
+
+        const auto latch = latch_of[i];
+        if (latch == BasicBlock::kNone) {
+            continue;
+        }
+        seeds[latch] = summary.uses;
+        const auto& exit = within[cfg.blocks[latch].on_false];
+        // An iteration followed by the exit.
+        auto& loop = entered[i];
+        loop.uses = exit.uses;
+        summary.Apply(loop.uses);
+        loop.writes = summary.writes;
+        loop.writes.merge(exit.writes);
     }
+    return seeds;
 }
 
-void WriteNamesCollector::Visit(Assignment& stmt) {
-    names.insert(stmt.variable->name);
+bool ByProgramOrder(const Statement* lhs, const Statement* rhs) {
+    return lhs->id < rhs->id;
 }
 
-void WriteNamesCollector::Visit(IfStatement& stmt) {
-    for (const auto& it: *stmt.body) {
-        it->Accept(*this);
-    }
 }
 
-void WriteNamesCollector::Visit(WhileStatement& stmt) {
-    for (const auto& it: *stmt.body) {
-        it->Accept(*this);
+void LiveVariableAnalyser::Analyse(Program& p) {
+    live_in_succ = {};
+    Analyse(Cfg::Build(p.statements));
+}
+
+void LiveVariableAnalyser::Analyse(const Cfg& cfg) {
+    Statistics::Timer timer(&Statistics::live_variables_ms);
+    const auto blocks = BlockSummaries(cfg);
+    LivenessProblem problem{cfg, blocks, LoopUses(cfg, blocks), live_in_succ};
+    const auto result = Solve(cfg, problem);
+    live_in_succ = result.before[cfg.entry];
+    unused.clear();
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        const auto& block = cfg.blocks[i];
+        auto live = result.after[i];
+        ReadCondition(block, live);
+        for (auto* assignment: block.assignments | std::views::reverse) {
+            if (live.erase(assignment->variable->name) == 0) {
+                unused.push_back(assignment);
+            }
+            live.insert_range(assignment->reads);
+        }
     }
+    for (auto* stmt: cfg.pruned) {
+        unused.insert(unused.end(), stmt->assignments.begin(), stmt->assignments.end());
+    }
+    std::ranges::sort(unused, ByProgramOrder);
 }
 
 void PossibleValueAnalyzer::Analyse(Program& p) {
-    Visit(*p.statements);
+    possible_values.Clear();
+    reachable = true;
+    budget.Restart();
+    AnalyseNext(p.statements, p.statement_count);
 }
 
-void PossibleValueAnalyzer::Visit(StatementList& sl) {
-    for (const auto& stmt: sl) {
-        stmt->Accept(*this);
+void PossibleValueAnalyzer::AnalyseNext(StatementList statements, uint32_t statement_count) {
+    Statistics::Timer timer(&Statistics::possible_values_ms);
+    never_happens.assign(statement_count, false);
+    always_happens.assign(statement_count, false);
+    branch_seen.assign(statement_count, false);
+    compiled_expressions.assign(statement_count, {});
+    open_loops = 0;
+    loop_exits.clear();
+    reduced_precision.clear();
+    if (domain == ValueDomain::kInterval) {
+        // One top-level statement at a time, so that each one starts from the
+        // narrowed values after the previous ones.
+        for (auto& stmt: statements) {
+            AnalyseRanges(Cfg::Build(StatementList(&stmt, 1)));
+        }
+    } else {
+        Visit(statements);
     }
+    // A loop within another one may be given up on every time it is reached.
+    std::ranges::sort(reduced_precision, ByProgramOrder);
+    reduced_precision.erase(std::unique(reduced_precision.begin(), reduced_precision.end()), reduced_precision.end());
 }
 
-void PossibleValueAnalyzer::EvalExpr(Expression& expr, std::set<int>& values) {
-    std::set<char> names;
-    expr.GetNames(names);
+const CompiledExpression& PossibleValueAnalyzer::Compile(const Statement& stmt, const Expression& expr,
+                                                          std::span<const Symbol> names) {
+    auto& compiled = compiled_expressions[stmt.id];
+    if (compiled.code.empty()) {
+        compiled = CompiledExpression(expr, names);
+    }
+    return compiled;
+}
 
+void PossibleValueAnalyzer::EvalExpr(const CompiledExpression& expr, ValueSet& values) {
+    Statistics::Add(&Statistics::expression_evaluations);
+    // Every name is read, even once the result is known to be unknown, so
+    // that which names become set does not depend on their order.
     size_t combination_count = 1;
-    for (auto it: names) {
-        combination_count *= possible_values[it].size();
-        if (combination_count == 0 || combination_count > kMaxCombinationCount) {
-            return;
-        }
+    for (auto it: expr.names) {
+        combination_count = std::min(combination_count * possible_values.Get(it).size(), kMaxCombinationCount + size_t{1});
     }
+    if (combination_count == 0) {
+        return;
+    }
+    if (combination_count > kMaxCombinationCount) {
+        Statistics::Add(&Statistics::combination_limit_hits);
+        return;
+    }
+    Statistics::Add(&Statistics::combinations_evaluated, combination_count);
+    budget.Spend(combination_count);
 
-    std::vector<std::map<char, int>> combinations(combination_count);
-    for (auto name: names) {
-        for (const auto& possible_value: possible_values[name]) {
-            for (size_t i = 0; i < combination_count; i += possible_values[name].size()) {
-                combinations[i][name] = possible_value;
-            }
+    // Lay the combinations out as one lane per combination and one array of
+    // lanes per name, padded to whole registers with copies of the first one.
+    constexpr auto kLaneCount = CompiledExpression::kLaneCount;
+    const size_t lane_count = (combination_count + kLaneCount - 1) / kLaneCount * kLaneCount;
+    lane_values.resize(expr.names.size() * lane_count);
+    evaluation_stack.resize(std::max(evaluation_stack.size(), expr.max_stack_size * lane_count));
+    lanes.clear();
+    int* lane = lane_values.data();
+    size_t stride = 1;
+    for (auto it: expr.names) {
+        const auto& name_values = possible_values.Get(it);
+        for (size_t i = 0; i < combination_count;) {
+            name_values.ForEach([&](int value) {
+                std::fill_n(lane + i, stride, value);
+                i += stride;
+            });
         }
+        std::fill(lane + combination_count, lane + lane_count, lane[0]);
+        stride *= name_values.size();
+        lanes.push_back(lane);
+        lane += lane_count;
     }
 
-    for (auto combination: combinations) {
-        auto evaluated = expr.Evaluate(combination);
-        values.insert(dynamic_pointer_cast<Constant>(evaluated)->value);
+    if (expr.EvaluateBatch(lanes.data(), lane_count, evaluation_stack.data())) {
+        values = DistinctValues(evaluation_stack.data(), combination_count);
     }
 }
 
 void PossibleValueAnalyzer::Visit(Assignment& assignment) {
-    std::set<int> values;
-    EvalExpr(*assignment.expression, values);
-    possible_values[assignment.variable->name] = std::move(values);
+    ValueSet values;
+    EvalExpr(Compile(assignment, *assignment.expression, assignment.reads), values);
+    possible_values.Set(assignment.variable->name, values);
 }
 
 void PossibleValueAnalyzer::Visit(IfStatement& if_statement) {
-    std::set<int> values;
-    EvalExpr(*if_statement.condition, values);
-    bool can_be_true = values.empty();
-    bool can_be_false = values.empty();
-    for (const auto& value: values) {
-        if (value) {
-            can_be_true = true;
-        } else {
-            can_be_false = true;
-        }
-        if (can_be_true && can_be_false) {
-            break;
-        }
-    }
+    ValueSet values;
+    EvalExpr(Compile(if_statement, *if_statement.condition, if_statement.condition_names), values);
+    // Unknown values may be anything.
+    const bool can_be_false = values.empty() || values.contains(0);
+    const bool can_be_true = values.empty() || values.size() > static_cast<size_t>(values.contains(0));
     const bool always_true = can_be_true && not can_be_false;
     const bool always_false = can_be_false && not can_be_true;
 
+    RecordBranch(if_statement, can_be_true, can_be_false);
     if (always_false) {
-        never_happens.push_back(if_statement.shared_from_this());
         return;
     }
     if (always_true) {
-        always_happens.push_back(if_statement.shared_from_this());
-        Visit(*if_statement.body);
-        return;
+        pending.push_back({&if_statement, 0, {}});
+    } else {
+        Statistics::Add(&Statistics::state_copies);
+        pending.push_back({&if_statement, 0, possible_values});
+    }
+    VisitBody(if_statement);
+}
+
+void PossibleValueAnalyzer::Leave(IfStatement& if_statement) {
+    if (const auto& skipped = pending.back().skipped) {
+        MergeSkipped(*skipped, if_statement.writes);
+    }
+    pending.pop_back();
+}
+
+namespace {
+
+const Expression* SkipParentheses(const Expression* expr) {
+    while (auto* priority = dynamic_cast<const PriorityExpression*>(expr)) {
+        expr = priority->expression;
+    }
+    return expr;
+}
+
+// The names an operand reads, in increasing order: unlike the expression of
+// a statement, an operand does not come with them.
+std::vector<Symbol> NamesOf(const Expression& expression) {
+    std::vector<Symbol> names;
+    std::vector<const Expression*> stack = {&expression};
+    while (!stack.empty()) {
+        const auto* node = stack.back();
+        stack.pop_back();
+        if (const auto* variable = dynamic_cast<const Variable*>(node)) {
+            names.push_back(variable->name);
+        }
+        for (size_t i = 0; i < node->OperandCount(); ++i) {
+            stack.push_back(node->Operand(i));
+        }
+    }
+    std::ranges::sort(names);
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+// A loop whose body steps a variable towards a bound it leaves alone.
+struct InductionLoop {
+    Symbol name;
+    int64_t step;
+    // Whether the loop runs while the variable is below the bound, rather
+    // than above it.
+    bool below;
+    // Read by the bound, which refers to them: the loop may be moved but
+    // not copied.
+    std::vector<Symbol> bound_names;
+    CompiledExpression bound;
+};
+
+bool Contains(std::span<const Symbol> names, Symbol name) {
+    return std::ranges::binary_search(names, name);
+}
+
+// The constant c of `name = name + c`, `name = c + name` or `name = name - c`.
+std::optional<int64_t> StepOf(const Assignment& assignment, Symbol name) {
+    auto* binary = dynamic_cast<const BinaryExpression*>(SkipParentheses(assignment.expression));
+    if (binary == nullptr || (binary->operation != '+' && binary->operation != '-')) {
+        return {};
+    }
+    auto* variable = dynamic_cast<const Variable*>(SkipParentheses(binary->left));
+    auto* constant = dynamic_cast<const Constant*>(SkipParentheses(binary->right));
+    if (variable == nullptr && binary->operation == '+') {
+        variable = dynamic_cast<const Variable*>(SkipParentheses(binary->right));
+        constant = dynamic_cast<const Constant*>(SkipParentheses(binary->left));
+    }
+    if (variable == nullptr || variable->name != name || constant == nullptr) {
+        return {};
+    }
+    return binary->operation == '+' ? int64_t{constant->value} : -int64_t{constant->value};
+}
+
+// The step of `name` when the body is straight-line, steps it exactly once
+// and carries no other value from one iteration to the next: every other
+// name the body writes is written before it is read.
+std::optional<int64_t> StepIn(const WhileStatement& loop, Symbol name) {
+    std::optional<int64_t> step;
+    VarSet written;
+    for (auto* stmt: loop.body) {
+        auto* assignment = dynamic_cast<const Assignment*>(stmt);
+        if (assignment == nullptr) {
+            return {};
+        }
+        const auto target = assignment->variable->name;
+        if (target == name) {
+            if (step.has_value()) {
+                return {};
+            }
+            step = StepOf(*assignment, name);
+            if (!step.has_value()) {
+                return {};
+            }
+        }
+        for (const auto read: assignment->reads) {
+            if (read != name && Contains(loop.writes, read) && !written.contains(read)) {
+                return {};
+            }
+        }
+        written.insert(target);
     }
-    auto original_possible_values = possible_values;
-    Visit(*if_statement.body);
-    for (auto& [n, v]: original_possible_values) {
-        if (possible_values[n].empty()) {
+    return step;
+}
+
+std::optional<InductionLoop> FindInductionLoop(const WhileStatement& loop) {
+    auto* condition = dynamic_cast<const BinaryExpression*>(SkipParentheses(loop.condition));
+    if (condition == nullptr || (condition->operation != '<' && condition->operation != '>')) {
+        return {};
+    }
+    for (const bool variable_left: {true, false}) {
+        auto* variable = dynamic_cast<const Variable*>(SkipParentheses(variable_left ? condition->left : condition->right));
+        if (variable == nullptr) {
+            continue;
+        }
+        const auto step = StepIn(loop, variable->name);
+        if (!step.has_value()) {
             continue;
         }
-        if (v.empty()) {
-            possible_values[n].clear();
+        const auto& bound = *(variable_left ? condition->right : condition->left);
+        auto bound_names = NamesOf(bound);
+        if (std::ranges::any_of(bound_names, [&](Symbol name) { return Contains(loop.writes, name); })) {
             continue;
         }
-        possible_values[n].merge(v);
-        if (possible_values[n].size() > kMaxCombinationCount) {
-            possible_values[n].clear();
+        const bool below = (condition->operation == '<') == variable_left;
+        // Stepping away from the bound only ends by wrapping around.
+        if (*step == 0 || below != (*step > 0)) {
+            return {};
         }
+        CompiledExpression compiled(bound, bound_names);
+        return InductionLoop{variable->name, *step, below, std::move(bound_names), std::move(compiled)};
     }
+    return {};
+}
+
+VarSet TouchedNames(const Statement& stmt) {
+    VarSet names;
+    names.insert_range(stmt.reads);
+    names.insert_range(stmt.writes);
+    return names;
+}
+
 }
 
 void PossibleValueAnalyzer::Visit(WhileStatement& while_statement) {
-    Visit(while_statement, 0);
+    // Only a loop within another one is analysed more than once.
+    std::optional<ValueState> entry;
+    if (open_loops > 0) {
+        if (ReuseLoopExit(while_statement)) {
+            return;
+        }
+        Statistics::Add(&Statistics::state_copies);
+        entry = possible_values;
+    }
+    if (SummarizeInductionLoop(while_statement) || !Visit(while_statement, 0)) {
+        if (entry.has_value()) {
+            StoreLoopExit(while_statement, std::move(*entry));
+        }
+        return;
+    }
+    if (entry.has_value()) {
+        pending.back().entry = std::move(*entry);
+    }
+    ++open_loops;
 }
 
-void PossibleValueAnalyzer::Visit(WhileStatement& while_statement, int depth) {
-    std::set<int> values;
-    EvalExpr(*while_statement.condition, values);
+uint64_t PossibleValueAnalyzer::LoopKey(const WhileStatement& while_statement, const ValueState& entry) const {
+    return entry.Hash(TouchedNames(while_statement)) ^ while_statement.id * 0x9e3779b97f4a7c15;
+}
 
-    const bool not_computable = values.empty();
-    if (not_computable || depth > kMaxDepth) {
-        WriteNamesCollector writeNamesGetter;
-        writeNamesGetter.Visit(*while_statement.body);
-        for (auto name: writeNamesGetter.names) {
-            possible_values[name].clear();
+bool PossibleValueAnalyzer::ReuseLoopExit(const WhileStatement& while_statement) {
+    const auto found = loop_exits.find(LoopKey(while_statement, possible_values));
+    if (found == loop_exits.end() || found->second.loop != &while_statement) {
+        return false;
+    }
+    // Nothing else is read or changed by the loop, so only these decide
+    // what it does.
+    const auto names = TouchedNames(while_statement);
+    const auto& [loop, entry, exit] = found->second;
+    if (!possible_values.HoldsSame(entry, names)) {
+        return false;
+    }
+    Statistics::Add(&Statistics::loop_exit_reuses);
+    for (const auto name: names) {
+        possible_values.Share(name, exit);
+    }
+    return true;
+}
+
+void PossibleValueAnalyzer::StoreLoopExit(const WhileStatement& while_statement, ValueState entry) {
+    if (loop_exits.size() >= kMaxLoopExits) {
+        loop_exits.clear();
+    }
+    const auto key = LoopKey(while_statement, entry);
+    loop_exits.insert_or_assign(key, LoopExit{&while_statement, std::move(entry), possible_values});
+}
+
+bool PossibleValueAnalyzer::SummarizeInductionLoop(WhileStatement& while_statement) {
+    const auto loop = FindInductionLoop(while_statement);
+    if (!loop.has_value()) {
+        return false;
+    }
+    const auto starts = possible_values.Get(loop->name);
+    ValueSet bounds;
+    EvalExpr(loop->bound, bounds);
+    if (starts.empty() || bounds.empty() || starts.size() * bounds.size() > kMaxCombinationCount) {
+        return false;
+    }
+
+    // The value at the start of the last iteration, for every start and
+    // bound that enter the loop.
+    ValueSet lasts;
+    bool can_skip = false;
+    bool fits = true;
+    starts.ForEach([&](int start) {
+        bounds.ForEach([&](int bound) {
+            const int64_t distance = loop->below ? int64_t{bound} - start : int64_t{start} - bound;
+            if (distance <= 0) {
+                can_skip = true;
+                return;
+            }
+            const int64_t magnitude = loop->step > 0 ? loop->step : -loop->step;
+            const int64_t last = start + (distance - 1) / magnitude * loop->step;
+            const int64_t exit = last + loop->step;
+            fits = fits && exit >= INT_MIN && exit <= INT_MAX;
+            lasts.Merge(ValueSet::Single(static_cast<int>(last)));
+        });
+    });
+    if (!fits) {
+        return false;
+    }
+    Statistics::Add(&Statistics::loop_summaries);
+    RecordBranch(while_statement, !lasts.empty(), can_skip);
+    if (lasts.empty()) {
+        return true;
+    }
+
+    // The last iteration gives the values after the loop, since the body
+    // carries nothing else over from the ones before.
+    std::optional<ValueState> skipped;
+    if (can_skip) {
+        Statistics::Add(&Statistics::state_copies);
+        skipped = possible_values;
+    }
+    possible_values.Set(loop->name, lasts);
+    for (auto* stmt: while_statement.body) {
+        Visit(static_cast<Assignment&>(*stmt));
+    }
+    if (skipped.has_value()) {
+        MergeSkipped(*skipped, while_statement.writes);
+    }
+    return true;
+}
+
+void PossibleValueAnalyzer::Leave(WhileStatement& while_statement) {
+    const auto& iteration = pending.back();
+    if (iteration.skipped.has_value() && possible_values == *iteration.skipped) {
+        // Every iteration from here on would repeat this one, and the values
+        // leaving the loop after them are those already leaving it here.
+        Statistics::Add(&Statistics::loop_fixpoints);
+    } else if (Visit(while_statement, iteration.depth + 1)) {
+        return;
+    }
+    // That was the last iteration: the paths that left the loop earlier join
+    // it, the latest first.
+    ValueState entry;
+    while (!pending.empty() && pending.back().statement == &while_statement) {
+        if (const auto& skipped = pending.back().skipped) {
+            MergeSkipped(*skipped, while_statement.writes);
         }
+        entry = std::move(pending.back().entry);
+        pending.pop_back();
+    }
+    if (--open_loops > 0) {
+        StoreLoopExit(while_statement, std::move(entry));
+    }
+}
+
+void PossibleValueAnalyzer::RecordBranch(const Statement& stmt, bool can_be_true, bool can_be_false) {
+    if (!branch_seen[stmt.id]) {
+        branch_seen[stmt.id] = true;
+        never_happens[stmt.id] = !can_be_true;
+        always_happens[stmt.id] = !can_be_false;
         return;
     }
+    never_happens[stmt.id] = never_happens[stmt.id] && !can_be_true;
+    always_happens[stmt.id] = always_happens[stmt.id] && !can_be_false;
+}
 
-    bool can_be_true = false;
-    bool can_be_false = false;
-    for (const auto value: values) {
-        if (value) {
-            can_be_true = true;
-        } else {
-            can_be_false = true;
+void PossibleValueAnalyzer::MergeSkipped(const ValueState& skipped, std::span<const Symbol> writes) {
+    for (const auto name: writes) {
+        // Names unset on the path that skipped the body are left to it, and
+        // values the body left alone are the same on both paths.
+        const auto* values = skipped.Find(name);
+        if (values == nullptr || possible_values.SharesValues(skipped, name) || possible_values.Get(name).empty()) {
+            continue;
         }
-        if (can_be_true && can_be_false) {
-            break;
+        if (values->empty()) {
+            possible_values.SetUnknown(name);
+            continue;
+        }
+        if (!possible_values.Modify(name).Merge(*values)) {
+            Statistics::Add(&Statistics::value_set_limit_hits);
+            possible_values.SetUnknown(name);
+        }
+    }
+}
+
+bool PossibleValueAnalyzer::Visit(WhileStatement& while_statement, int depth) {
+    ValueSet values;
+    EvalExpr(Compile(while_statement, *while_statement.condition, while_statement.condition_names), values);
+
+    Statistics::Max(&Statistics::max_loop_depth, depth);
+    const bool not_computable = values.empty();
+    if (not_computable || depth > kMaxDepth) {
+        if (!not_computable) {
+            Statistics::Add(&Statistics::loop_depth_limit_hits);
+        } else if (depth == 0) {
+            RecordBranch(while_statement, true, true);
         }
+        GiveUp(while_statement);
+        return false;
     }
 
+    const bool can_be_false = values.contains(0);
+    const bool can_be_true = values.size() > static_cast<size_t>(can_be_false);
+
     const bool always_true = can_be_true && not can_be_false;
     const bool always_false = can_be_false && not can_be_true;
 
+    if (depth == 0) {
+        RecordBranch(while_statement, can_be_true, can_be_false);
+    }
     if (always_false) {
-        if (depth == 0) {
-            never_happens.push_back(while_statement.shared_from_this());
-        }
-        return;
+        return false;
+    }
+    if (budget.Exhausted()) {
+        Statistics::Add(&Statistics::budget_cutoffs);
+        reduced_precision.push_back(&while_statement);
+        GiveUp(while_statement);
+        return false;
     }
     if (always_true) {
-        if (depth == 0) {
-            always_happens.push_back(while_statement.shared_from_this());
+        pending.push_back({&while_statement, depth, {}});
+    } else {
+        Statistics::Add(&Statistics::state_copies);
+        pending.push_back({&while_statement, depth, possible_values});
+    }
+    VisitBody(while_statement);
+    return true;
+}
+
+void PossibleValueAnalyzer::GiveUp(const WhileStatement& while_statement) {
+    for (auto name: while_statement.writes) {
+        possible_values.SetUnknown(name);
+    }
+    // The statements nested in the loop are numbered right after it, up to
+    // the last one of its innermost last body.
+    const Statement* last = &while_statement;
+    while (true) {
+        StatementList body;
+        if (const auto* loop = dynamic_cast<const WhileStatement*>(last)) {
+            body = loop->body;
+        } else if (const auto* branch = dynamic_cast<const IfStatement*>(last)) {
+            body = branch->body;
+        }
+        if (body.empty()) {
+            break;
         }
-        Visit(*while_statement.body);
-        Visit(while_statement, depth + 1);
+        last = body.back();
+    }
+    const auto first = while_statement.id + 1;
+    const auto end = last->id + 1;
+    std::fill(never_happens.begin() + first, never_happens.begin() + end, false);
+    std::fill(always_happens.begin() + first, always_happens.begin() + end, false);
+    std::fill(branch_seen.begin() + first, branch_seen.begin() + end, true);
+}
+
+PossibleValueAnalyzer::State PossibleValueAnalyzer::Snapshot() const {
+    Statistics::Add(&Statistics::state_copies);
+    return {possible_values};
+}
+
+void PossibleValueAnalyzer::Restore(State state) {
+    possible_values = std::move(state.possible_values);
+}
+
+Interval PossibleValueAnalyzer::RangeOf(Symbol name) {
+    return possible_values.RangeOf(name);
+}
+
+void PossibleValueAnalyzer::SetRange(Symbol name, Interval range) {
+    possible_values.SetRange(name, range, kMaxCombinationCount);
+}
+
+void PossibleValueAnalyzer::EvalValue(const CompiledExpression& expr, ValueSet& values, Interval& range) {
+    EvalExpr(expr, values);
+    if (!values.empty()) {
+        range = {values.min(), values.max()};
         return;
     }
-    auto original_possible_values = possible_values;
-    Visit(*while_statement.body);
-    Visit(while_statement, depth + 1);
-    for (auto& [n, v]: original_possible_values) {
-        if (possible_values[n].empty()) {
+    ranges.clear();
+    for (auto it: expr.names) {
+        ranges.push_back(RangeOf(it));
+    }
+    range_stack.resize(std::max(range_stack.size(), expr.max_stack_size));
+    range = expr.EvaluateRange(ranges.data(), range_stack.data());
+}
+
+std::pair<bool, bool> PossibleValueAnalyzer::EvalCondition(const CompiledExpression& expr) {
+    ValueSet values;
+    Interval range;
+    EvalValue(expr, values, range);
+    if (values.empty()) {
+        return {range != Interval{0, 0}, range.lo <= 0 && range.hi >= 0};
+    }
+    return {values.size() > 1 || values.min() != 0, values.contains(0)};
+}
+
+namespace {
+
+const ValueSet* ValuesIn(const PossibleValueAnalyzer::State& state, Symbol name) {
+    const auto* values = state.possible_values.Find(name);
+    return values == nullptr || values->empty() ? nullptr : values;
+}
+
+Interval RangeIn(const PossibleValueAnalyzer::State& state, Symbol name) {
+    return state.possible_values.RangeOf(name);
+}
+
+VarSet NamesIn(const PossibleValueAnalyzer::State& state) {
+    return state.possible_values.Names();
+}
+
+bool Includes(const PossibleValueAnalyzer::State& outer, const PossibleValueAnalyzer::State& inner, Symbol name) {
+    const auto* outer_values = ValuesIn(outer, name);
+    const auto* inner_values = ValuesIn(inner, name);
+    if (outer_values == nullptr) {
+        return RangeIn(outer, name).Contains(RangeIn(inner, name));
+    }
+    return inner_values != nullptr && outer_values->Includes(*inner_values);
+}
+
+}
+
+bool PossibleValueAnalyzer::Refine(const Expression& condition, bool outcome) {
+    // Only `name < bound` and `name > bound` (either way round) are understood,
+    // where the bound is a constant or another variable.
+    auto* binary = dynamic_cast<const BinaryExpression*>(SkipParentheses(&condition));
+    if (binary == nullptr || (binary->operation != '<' && binary->operation != '>')) {
+        return true;
+    }
+    bool less = binary->operation == '<';
+    auto* variable = dynamic_cast<const Variable*>(SkipParentheses(binary->left));
+    auto* other = SkipParentheses(binary->right);
+    if (variable == nullptr) {
+        variable = dynamic_cast<const Variable*>(SkipParentheses(binary->right));
+        other = SkipParentheses(binary->left);
+        less = !less;
+    }
+    if (variable == nullptr) {
+        return true;
+    }
+    Interval bound;
+    if (auto* constant = dynamic_cast<const Constant*>(other)) {
+        bound = {constant->value, constant->value};
+    } else if (auto* other_variable = dynamic_cast<const Variable*>(other)) {
+        bound = RangeOf(other_variable->name);
+    } else {
+        return true;
+    }
+
+    int64_t lo = INT_MIN;
+    int64_t hi = INT_MAX;
+    if (less == outcome) {
+        // name < bound or name <= bound
+        hi = static_cast<int64_t>(bound.hi) - outcome;
+    } else {
+        // name > bound or name >= bound
+        lo = static_cast<int64_t>(bound.lo) + outcome;
+    }
+    const auto name = variable->name;
+    if (possible_values.KindOf(name) == ValueState::Kind::kValues) {
+        if (possible_values.Modify(name).EraseOutside(lo, hi)) {
+            return true;
+        }
+        possible_values.SetUnknown(name);
+        return false;
+    }
+    const auto range = RangeOf(name);
+    lo = std::max<int64_t>(lo, range.lo);
+    hi = std::min<int64_t>(hi, range.hi);
+    if (lo > hi) {
+        return false;
+    }
+    SetRange(name, {static_cast<int>(lo), static_cast<int>(hi)});
+    return true;
+}
+
+void PossibleValueAnalyzer::Join(const State& other) {
+    auto names = NamesIn(other);
+    names.merge(NamesIn(Snapshot()));
+    for (auto name: names) {
+        const auto* other_values = ValuesIn(other, name);
+        if (possible_values.KindOf(name) == ValueState::Kind::kValues && other_values != nullptr
+            && possible_values.Modify(name).Merge(*other_values)) {
             continue;
         }
-        if (v.empty()) {
-            possible_values[n].clear();
+        const auto range = RangeOf(name);
+        const auto other_range = RangeIn(other, name);
+        SetRange(name, {std::min(range.lo, other_range.lo), std::max(range.hi, other_range.hi)});
+    }
+}
+
+void PossibleValueAnalyzer::Widen(const State& previous) {
+    const auto current = Snapshot();
+    auto names = NamesIn(previous);
+    names.merge(NamesIn(current));
+    for (auto name: names) {
+        const auto old_range = RangeIn(previous, name);
+        if (Includes(previous, current, name)) {
+            if (ValuesIn(previous, name) != nullptr) {
+                possible_values.Share(name, previous.possible_values);
+            } else {
+                SetRange(name, old_range);
+            }
             continue;
         }
-        possible_values[n].merge(v);
-        if (possible_values[n].size() > kMaxCombinationCount) {
-            possible_values[n].clear();
+        // Bounds that keep moving are pushed to infinity.
+        const auto range = RangeOf(name);
+        SetRange(name, {range.lo < old_range.lo ? INT_MIN : old_range.lo,
+                        range.hi > old_range.hi ? INT_MAX : old_range.hi});
+    }
+}
+
+void PossibleValueAnalyzer::Narrow(const State& previous) {
+    auto names = NamesIn(previous);
+    names.merge(NamesIn(Snapshot()));
+    for (auto name: names) {
+        if (ValuesIn(previous, name) != nullptr) {
+            possible_values.Share(name, previous.possible_values);
+            continue;
         }
+        // Only the infinite bounds introduced by widening are narrowed.
+        const auto old_range = RangeIn(previous, name);
+        const auto range = RangeOf(name);
+        const Interval narrowed{old_range.lo == INT_MIN ? range.lo : old_range.lo,
+                                old_range.hi == INT_MAX ? range.hi : old_range.hi};
+        SetRange(name, narrowed.lo <= narrowed.hi ? narrowed : old_range);
     }
 }
 
-void AssignmentCollector::Visit(StatementList& sl) {
-    for (const auto& stmt: sl) {
-        stmt->Accept(*this);
+bool PossibleValueAnalyzer::IsIncludedIn(const State& other) {
+    const auto current = Snapshot();
+    auto names = NamesIn(other);
+    names.merge(NamesIn(current));
+    for (auto name: names) {
+        if (!Includes(other, current, name)) {
+            return false;
+        }
     }
+    return true;
 }
 
-void AssignmentCollector::Visit(Assignment& stmt) {
-    assignments.push_back(stmt.shared_from_this());
+void PossibleValueAnalyzer::VisitRanges(Assignment& assignment) {
+    ValueSet values;
+    Interval range;
+    EvalValue(Compile(assignment, *assignment.expression, assignment.reads), values, range);
+    const auto name = assignment.variable->name;
+    if (values.empty()) {
+        SetRange(name, range);
+        return;
+    }
+    possible_values.Set(name, values);
 }
 
-void AssignmentCollector::Visit(IfStatement& stmt) {
-    for (const auto& it: *stmt.body) {
-        it->Accept(*this);
+namespace {
+
+// The interval domain as a forward problem, evaluated with the analyser's
+// helpers on its current state. nullopt stands for unreachable code.
+struct RangeProblem {
+    using Value = std::optional<PossibleValueAnalyzer::State>;
+    constexpr static Direction kDirection = Direction::kForward;
+
+    PossibleValueAnalyzer& analyzer;
+    Value entry;
+    std::unordered_map<const BasicBlock*, int> back_edge_joins{};
+    // The targets of the back edges widened before kWideningDelay joins.
+    std::unordered_set<const BasicBlock*> widened_early{};
+
+    Value Bottom() const {
+        return std::nullopt;
+    }
+
+    Value Boundary() const {
+        return entry;
+    }
+
+    Value Transfer(const BasicBlock& block, const Value& value) {
+        if (!value || block.assignments.empty()) {
+            return value;
+        }
+        analyzer.Restore(*value);
+        for (auto* assignment: block.assignments) {
+            analyzer.VisitRanges(*assignment);
+        }
+        return analyzer.Snapshot();
     }
+
+    Value TransferEdge(const BasicBlock& block, uint32_t to, const Value& value) {
+        if (!value || block.condition == nullptr) {
+            return value;
+        }
+        const bool outcome = to == block.on_true;
+        analyzer.Restore(*value);
+        const auto [can_be_true, can_be_false] =
+                analyzer.EvalCondition(analyzer.Compile(*block.branch, *block.condition, block.condition_names));
+        if (!(outcome ? can_be_true : can_be_false) || !analyzer.Refine(*block.condition, outcome)) {
+            return std::nullopt;
+        }
+        return analyzer.Snapshot();
+    }
+
+    bool Join(const BasicBlock& block, Value& into, const Value& value, bool back_edge) {
+        if (!value) {
+            return false;
+        }
+        if (!into) {
+            into = value;
+            return true;
+        }
+        analyzer.Restore(*into);
+        analyzer.Join(*value);
+        if (back_edge) {
+            // Once the budget runs out, loops are widened right away.
+            const bool delayed = ++back_edge_joins[&block] <= PossibleValueAnalyzer::kWideningDelay;
+            if (delayed && analyzer.budget.Exhausted() && widened_early.insert(&block).second) {
+                Statistics::Add(&Statistics::budget_cutoffs);
+            }
+            if (!delayed || analyzer.budget.Exhausted()) {
+                analyzer.Widen(*into);
+            }
+        }
+        if (analyzer.IsIncludedIn(*into)) {
+            return false;
+        }
+        into = analyzer.Snapshot();
+        return true;
+    }
+
+    void Narrow(const BasicBlock&, Value& input, const Value& computed) {
+        if (!input || !computed) {
+            input = computed;
+            return;
+        }
+        analyzer.Restore(*computed);
+        analyzer.Narrow(*input);
+        input = analyzer.Snapshot();
+    }
+};
+
 }
 
-void AssignmentCollector::Visit(WhileStatement& stmt) {
-    for (const auto& it: *stmt.body) {
-        it->Accept(*this);
+void PossibleValueAnalyzer::AnalyseRanges(const Cfg& cfg) {
+    RangeProblem problem{*this, reachable ? RangeProblem::Value(Snapshot()) : std::nullopt};
+    const auto result = Solve(cfg, problem);
+    // Every if and while checks its condition on entry in exactly one block,
+    // whose final state covers all the times the statement is reached. The
+    // body of a statement that is never reached never happens either.
+    for (size_t i = 0; i < cfg.blocks.size(); ++i) {
+        const auto& block = cfg.blocks[i];
+        if (block.condition == nullptr || block.is_latch) {
+            continue;
+        }
+        if (!result.after[i]) {
+            never_happens[block.branch->id] = true;
+            continue;
+        }
+        Restore(*result.after[i]);
+        const auto [can_be_true, can_be_false] = EvalCondition(Compile(*block.branch, *block.condition, block.condition_names));
+        never_happens[block.branch->id] = !can_be_true;
+        always_happens[block.branch->id] = !can_be_false;
+    }
+    for (const auto& block: cfg.blocks) {
+        if (block.is_latch && problem.widened_early.contains(&cfg.blocks[block.on_true])) {
+            reduced_precision.push_back(static_cast<const WhileStatement*>(block.branch));
+        }
     }
+    reachable = result.after[cfg.exit].has_value();
+    Restore(result.after[cfg.exit].value_or(State{}));
+}
+
+std::string ReducedPrecisionLine(const WhileStatement& loop) {
+    std::ostringstream line;
+    line << "reduced precision: while " << *loop.condition;
+    return std::move(line).str();
 }
 
 void MixedAnalyser::Analyse(Program& p) {
     possible_value_analyzer.Analyse(p);
-    LiveVariableAnalyser::Analyse(p);
-}
-
-void MixedAnalyser::Visit(IfStatement& stmt) {
-    using namespace std::ranges;
-    const auto& never_happens = possible_value_analyzer.never_happens;
-    const auto& always_happens = possible_value_analyzer.always_happens;
-    if (find(never_happens, stmt.shared_from_this()) != end(never_happens)) {
-        stmt.condition->GetNames(live_in_succ);
-        AssignmentCollector c;
-        c.Visit(*stmt.body);
-        unused.insert(unused.end(), c.assignments.begin(), c.assignments.end());
-        return;
+    live_in_succ = {};
+    LiveVariableAnalyser::Analyse(Cfg::Build(p.statements,
+                                             possible_value_analyzer.never_happens,
+                                             possible_value_analyzer.always_happens));
+}
+
+void SsaAnalyser::Analyse(Program& p) {
+    Statistics::Timer timer(&Statistics::ssa_ms);
+    const auto cfg = Cfg::Build(p.statements);
+    const auto ssa = Ssa::Build(cfg);
+    const auto constants = SparseConstants::Propagate(cfg, ssa);
+
+    never_happens.assign(p.statement_count, false);
+    always_happens.assign(p.statement_count, false);
+    for (uint32_t block = 0; block < cfg.blocks.size(); ++block) {
+        const auto& basic_block = cfg.blocks[block];
+        if (basic_block.branch == nullptr || basic_block.is_latch || !constants.executable_blocks[block]) {
+            continue;
+        }
+        never_happens[basic_block.branch->id] = !constants.IsExecutable(cfg, block, basic_block.on_true);
+        always_happens[basic_block.branch->id] = !constants.IsExecutable(cfg, block, basic_block.on_false);
     }
-    if (find(always_happens, stmt.shared_from_this()) != end(always_happens)) {
-        LiveVariableAnalyser::Visit(*stmt.body);
-        stmt.condition->GetNames(live_in_succ);
-        return;
+
+    // The values read by executable code, and those reaching them through
+    // phis along executable edges. As for liveness, the condition of a loop
+    // is read on entry only.
+    std::vector<bool> read(ssa.values.size(), false);
+    std::vector<uint32_t> worklist;
+    const auto mark = [&](uint32_t value) {
+        if (!read[value]) {
+            read[value] = true;
+            worklist.push_back(value);
+        }
+    };
+    for (uint32_t block = 0; block < cfg.blocks.size(); ++block) {
+        if (!constants.executable_blocks[block]) {
+            continue;
+        }
+        for (const auto value: ssa.Definitions(block)) {
+            if (ssa.values[value].kind == SsaValue::Kind::kAssignment) {
+                std::ranges::for_each(ssa.Operands(value), mark);
+            }
+        }
+        if (!cfg.blocks[block].is_latch) {
+            std::ranges::for_each(ssa.ConditionOperands(block), mark);
+        }
     }
-    LiveVariableAnalyser::Visit(stmt);
+    while (!worklist.empty()) {
+        const auto value = worklist.back();
+        worklist.pop_back();
+        if (ssa.values[value].kind != SsaValue::Kind::kPhi) {
+            continue;
+        }
+        const auto operands = ssa.Operands(value);
+        for (size_t i = 0; i < operands.size(); ++i) {
+            if (constants.IsExecutable(ssa.values[value].block, i)) {
+                mark(operands[i]);
+            }
+        }
+    }
+
+    unused.clear();
+    for (uint32_t value = 0; value < ssa.values.size(); ++value) {
+        const auto& definition = ssa.values[value];
+        if (definition.kind == SsaValue::Kind::kAssignment
+            && (!constants.executable_blocks[definition.block] || !read[value])) {
+            unused.push_back(definition.assignment);
+        }
+    }
+    std::ranges::sort(unused, ByProgramOrder);
 }
 
-void MixedAnalyser::Visit(WhileStatement& stmt) {
-    using namespace std::ranges;
-    const auto& never_happens = possible_value_analyzer.never_happens;
-    const auto& always_happens = possible_value_analyzer.always_happens;
-    if (find(never_happens, stmt.shared_from_this()) != end(never_happens)) {
-        stmt.condition->GetNames(live_in_succ);
-        AssignmentCollector c;
-        c.Visit(*stmt.body);
-        unused.insert(unused.end(), c.assignments.begin(), c.assignments.end());
-        return;
+namespace {
+
+// Forward reaching definitions of the assignments not read yet; reads are
+// appended to `used` as the solver goes. As for liveness, the condition of a
+// loop is read on entry only.
+struct ReachingProblem {
+    using Value = StreamingAnalyser::Definitions;
+    constexpr static Direction kDirection = Direction::kForward;
+
+    const Value& entry;
+    uint64_t base_position;
+    std::vector<uint64_t>& used;
+
+    Value Bottom() const {
+        return {};
     }
-    if (find(always_happens, stmt.shared_from_this()) != end(always_happens)) {
-        std::set<char> original_live_in_succ = live_in_succ;
-        const auto previous_size = unused.size();
 
-        LiveVariableAnalyser::Visit(*stmt.body);
-        unused.resize(previous_size);
-        live_in_succ.merge(original_live_in_succ);
-        LiveVariableAnalyser::Visit(*stmt.body);
+    Value Boundary() const {
+        return entry;
+    }
 
-        stmt.condition->GetNames(live_in_succ);
-        return;
+    void Read(std::span<const Symbol> names, Value& reaching) const {
+        for (const auto name: names) {
+            if (const auto it = reaching.find(name); it != reaching.end()) {
+                used.insert(used.end(), it->second.begin(), it->second.end());
+                reaching.erase(it);
+            }
+        }
+    }
+
+    Value Transfer(const BasicBlock& block, Value reaching) const {
+        for (const auto* assignment: block.assignments) {
+            Read(assignment->reads, reaching);
+            reaching[assignment->variable->name] = {base_position + assignment->id};
+        }
+        if (block.condition != nullptr && !block.is_latch) {
+            Read(block.condition_names, reaching);
+        }
+        return reaching;
+    }
+
+    bool Join(const BasicBlock&, Value& into, const Value& value, bool) const {
+        bool changed = false;
+        for (const auto& [name, positions]: value) {
+            auto& into_positions = into[name];
+            const auto previous_size = into_positions.size();
+            into_positions.insert(positions.begin(), positions.end());
+            changed |= into_positions.size() != previous_size;
+        }
+        return changed;
+    }
+};
+
+std::string ToString(const Statement& stmt) {
+    thread_local std::ostringstream text;
+    text.str({});
+    text << stmt;
+    return text.str();
+}
+
+}
+
+void StreamingAnalyser::Analyse(Program& p) {
+    possible_value_analyzer.AnalyseNext(p.statements, p.statement_count);
+    for (const auto* loop: possible_value_analyzer.reduced_precision) {
+        reduced_precision.push_back(ReducedPrecisionLine(*loop));
+    }
+    Statistics::Timer timer(&Statistics::live_variables_ms);
+    std::vector<uint64_t> used;
+    ReachingProblem problem{reaching, next_position, used};
+    Definitions exit;
+    if (auto* assignment = dynamic_cast<Assignment*>(p.statements.front()); p.statements.size() == 1 && assignment) {
+        // The common case of a lone assignment is a single block, which needs
+        // no graph nor solver.
+        BasicBlock block;
+        block.assignments.push_back(assignment);
+        exit = problem.Transfer(block, std::move(reaching));
+    } else {
+        const auto cfg = Cfg::Build(p.statements,
+                                    possible_value_analyzer.never_happens,
+                                    possible_value_analyzer.always_happens);
+        exit = std::move(Solve(cfg, problem).after[cfg.exit]);
+    }
+    std::ranges::sort(used);
+    const auto is_used = [&](uint64_t position) {
+        return std::ranges::binary_search(used, position);
+    };
+    std::vector<uint64_t> still_reaching;
+    for (auto& [name, positions]: exit) {
+        std::erase_if(positions, is_used);
+        still_reaching.insert(still_reaching.end(), positions.begin(), positions.end());
+    }
+    std::ranges::sort(still_reaching);
+    const auto is_still_reaching = [&](uint64_t position) {
+        return std::ranges::binary_search(still_reaching, position);
+    };
+    std::erase_if(exit, [](const auto& entry) { return entry.second.empty(); });
+    reaching = std::move(exit);
+
+    unused.clear();
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (is_still_reaching(it->first)) {
+            ++it;
+            continue;
+        }
+        if (!is_used(it->first)) {
+            unused.push_back(std::move(it->second));
+        }
+        it = pending.erase(it);
+    }
+    for (auto* stmt: p.assignments) {
+        const auto position = next_position + stmt->id;
+        if (is_still_reaching(position)) {
+            pending[position] = ToString(*stmt);
+        } else if (!is_used(position)) {
+            unused.push_back(ToString(*stmt));
+        }
+    }
+    next_position += p.statement_count;
+}
+
+void StreamingAnalyser::Finish() {
+    unused.clear();
+    for (auto& [position, text]: pending) {
+        unused.push_back(std::move(text));
     }
-    LiveVariableAnalyser::Visit(stmt);
+    pending.clear();
+    reaching.clear();
 }
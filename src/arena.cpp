@@ -0,0 +1,30 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include "arena.h"
+
+void* Arena::AllocateSlow(size_t size, size_t align) {
+    const size_t needed = size + align;
+    while (current_block_ + 1 < blocks_.size()) {
+        auto& block = blocks_[++current_block_];
+        if (block.size >= needed) {
+            current_ = block.data.get();
+            left_ = block.size;
+            return Allocate(size, align);
+        }
+    }
+    const size_t block_size = std::max(kBlockSize, needed);
+    blocks_.push_back({std::unique_ptr<std::byte[]>(new std::byte[block_size]), block_size});
+    current_block_ = blocks_.size() - 1;
+    current_ = blocks_.back().data.get();
+    left_ = block_size;
+    return Allocate(size, align);
+}
+
+void Arena::Reset() {
+    current_block_ = 0;
+    current_ = blocks_.empty() ? nullptr : blocks_.front().data.get();
+    left_ = blocks_.empty() ? 0 : blocks_.front().size;
+}
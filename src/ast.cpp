@@ -3,93 +3,116 @@
 //
 
 #include <iostream>
+#include <vector>
 #include "ast.h"
+#include "compiled_expression.h"
 
-Variable::Variable(char name) : name(name) {}
+Variable::Variable(Symbol name, const char* identifier) : name(name), identifier(identifier) {}
 
-void Variable::GetNames(std::set<char> &names) const {
-    names.insert(name);
+void Variable::Print(std::ostream &os, size_t part) const {
+    os << identifier;
 }
 
-void Variable::Print(std::ostream &os) const {
-    os << name;
+Expression* Variable::Evaluate(std::span<const std::optional<int>> variables, Arena &arena) {
+    if (name < variables.size() && variables[name].has_value()) {
+        return arena.New<Constant>(*variables[name]);
+    }
+    return this;
 }
 
-std::shared_ptr<Expression> Variable::Evaluate(std::map<char, int> &variables) {
-    if (variables.contains(name)) {
-        return std::make_shared<Constant>(variables[name]);
-    }
-    return std::make_shared<Variable>(name);
+void Variable::Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const {
+    compiled.Emit(CompiledExpression::OpCode::kVariable, static_cast<int>(name));
 }
 
 Constant::Constant(int value) : value(value) {}
 
-void Constant::GetNames(std::set<char> &names) const {}
-
-void Constant::Print(std::ostream &os) const {
+void Constant::Print(std::ostream &os, size_t part) const {
     os << value;
 }
 
-std::shared_ptr<Expression> Constant::Evaluate(std::map<char, int> &variables) {
-    return std::make_shared<Constant>(value);
+Expression* Constant::Evaluate(std::span<const std::optional<int>> variables, Arena &arena) {
+    return this;
+}
+
+void Constant::Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const {
+    compiled.Emit(CompiledExpression::OpCode::kConstant, value);
 }
 
-BinaryExpression::BinaryExpression(std::shared_ptr<Expression> left, char operation, std::shared_ptr<Expression> right)
-        : left(std::move(left)), right(std::move(right)), operation(operation) {}
+BinaryExpression::BinaryExpression(Expression* left, char operation, Expression* right)
+        : left(left), right(right), operation(operation) {}
 
-void BinaryExpression::GetNames(std::set<char> &names) const {
-    left->GetNames(names);
-    right->GetNames(names);
+size_t BinaryExpression::OperandCount() const {
+    return 2;
 }
 
-void BinaryExpression::Print(std::ostream &os) const {
-    os << *left << ' ' << operation << ' ' << *right;
+const Expression* BinaryExpression::Operand(size_t index) const {
+    return index == 0 ? left : right;
 }
 
-std::shared_ptr<Expression> BinaryExpression::Evaluate(std::map<char, int> &variables) {
-    auto left_value = dynamic_pointer_cast<Constant>(left->Evaluate(variables));
-    auto right_value = dynamic_pointer_cast<Constant>(right->Evaluate(variables));
+void BinaryExpression::Print(std::ostream &os, size_t part) const {
+    if (part == 1) {
+        os << ' ' << operation << ' ';
+    }
+}
+
+Expression* BinaryExpression::Evaluate(std::span<const std::optional<int>> variables, Arena &arena) {
+    auto* left_value = dynamic_cast<Constant*>(left->Evaluate(variables, arena));
+    auto* right_value = dynamic_cast<Constant*>(right->Evaluate(variables, arena));
     if (left_value && right_value) {
         switch (operation) {
             case '+':
-                return std::make_shared<Constant>(left_value->value + right_value->value);
+                return arena.New<Constant>(left_value->value + right_value->value);
             case '-':
-                return std::make_shared<Constant>(left_value->value - right_value->value);
+                return arena.New<Constant>(left_value->value - right_value->value);
             case '*':
-                return std::make_shared<Constant>(left_value->value * right_value->value);
+                return arena.New<Constant>(left_value->value * right_value->value);
             case '/':
-                return std::make_shared<Constant>(left_value->value / right_value->value);
+                return arena.New<Constant>(left_value->value / right_value->value);
             case '<':
-                return std::make_shared<Constant>(left_value->value < right_value->value);
+                return arena.New<Constant>(left_value->value < right_value->value);
             case '>':
-                return std::make_shared<Constant>(left_value->value > right_value->value);
+                return arena.New<Constant>(left_value->value > right_value->value);
         }
     }
     if (left_value) {
-        return std::make_shared<BinaryExpression>(left_value, operation, right);
+        return arena.New<BinaryExpression>(left_value, operation, right);
     }
     if (right_value) {
-        return std::make_shared<BinaryExpression>(left, operation, right_value);
+        return arena.New<BinaryExpression>(left, operation, right_value);
     }
-    return std::make_shared<BinaryExpression>(left, operation, right);
+    return this;
+}
+
+void BinaryExpression::Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const {
+    compiled.Emit(CompiledExpression::BinaryOpCode(operation));
+    operands.push_back(left);
+    operands.push_back(right);
 }
 
-PriorityExpression::PriorityExpression(std::shared_ptr<Expression> expression) : expression(std::move(expression)) {}
+PriorityExpression::PriorityExpression(Expression* expression) : expression(expression) {}
 
-void PriorityExpression::GetNames(std::set<char> &names) const {
-    expression->GetNames(names);
+size_t PriorityExpression::OperandCount() const {
+    return 1;
 }
 
-void PriorityExpression::Print(std::ostream &os) const {
-    os << '(' << *expression << ')';
+const Expression* PriorityExpression::Operand(size_t index) const {
+    return expression;
 }
 
-std::shared_ptr<Expression> PriorityExpression::Evaluate(std::map<char, int> &variables) {
-    return expression->Evaluate(variables);
+void PriorityExpression::Print(std::ostream &os, size_t part) const {
+    os << (part == 0 ? '(' : ')');
 }
 
-Assignment::Assignment(std::shared_ptr<Variable> variable, std::shared_ptr<Expression> expression)
-        : variable(std::move(variable)), expression(std::move(expression)) {}
+Expression* PriorityExpression::Evaluate(std::span<const std::optional<int>> variables, Arena &arena) {
+    return expression->Evaluate(variables, arena);
+}
+
+void PriorityExpression::Compile(CompiledExpression &compiled, std::vector<const Expression*> &operands) const {
+    operands.push_back(expression);
+}
+
+Assignment::Assignment(Variable* variable, Expression* expression)
+        : variable(variable), expression(expression) {}
 
 void Assignment::Print(std::ostream &os) const {
     os << *variable << " = " << *expression;
@@ -99,14 +122,50 @@ void Assignment::Accept(StatementVisitor &visitor) {
     visitor.Visit(*this);
 }
 
-IfStatement::IfStatement(std::shared_ptr<Expression> condition, std::shared_ptr<StatementList> body)
-        : condition(std::move(condition)), body(std::move(body)) {}
+namespace {
+
+// Prints the statements of a body, each on lines of its own starting with an
+// indent, and those nested in them the same way.
+class BodyPrinter : public IterativeVisitor {
+    std::ostream &os_;
+
+public:
+    explicit BodyPrinter(std::ostream &os) : os_(os) {}
+
+    void Visit(Assignment &stmt) override {
+        os_ << "  " << stmt << '\n';
+    }
+
+    void Visit(IfStatement &stmt) override {
+        os_ << "  if " << *stmt.condition << '\n';
+        VisitBody(stmt);
+    }
+
+    void Visit(WhileStatement &stmt) override {
+        os_ << "  while " << *stmt.condition << '\n';
+        VisitBody(stmt);
+    }
+
+    void Leave(IfStatement &stmt) override {
+        os_ << "end\n";
+    }
+
+    void Leave(WhileStatement &stmt) override {
+        os_ << "end\n";
+    }
+
+    using IterativeVisitor::Visit;
+};
+
+}
+
+IfStatement::IfStatement(Expression* condition, StatementList body)
+        : condition(condition), body(body) {}
 
 void IfStatement::Print(std::ostream &os) const {
     os << "if " << *condition << '\n';
-    for (const auto &stmt: *body) {
-        os << "  " << *stmt << '\n';
-    }
+    auto statements = body;
+    BodyPrinter(os).Visit(statements);
     os << "end";
 }
 
@@ -114,14 +173,13 @@ void IfStatement::Accept(StatementVisitor &visitor) {
     visitor.Visit(*this);
 }
 
-WhileStatement::WhileStatement(std::shared_ptr<Expression> condition, std::shared_ptr<StatementList> body)
-        : condition(std::move(condition)), body(std::move(body)) {}
+WhileStatement::WhileStatement(Expression* condition, StatementList body)
+        : condition(condition), body(body) {}
 
 void WhileStatement::Print(std::ostream &os) const {
     os << "while " << *condition << '\n';
-    for (const auto &stmt: *body) {
-        os << "  " << *stmt << '\n';
-    }
+    auto statements = body;
+    BodyPrinter(os).Visit(statements);
     os << "end";
 }
 
@@ -129,8 +187,37 @@ void WhileStatement::Accept(StatementVisitor &visitor) {
     visitor.Visit(*this);
 }
 
-Program::Program(std::shared_ptr<StatementList> statements)
-        : statements(std::move(statements)) {}
+void IterativeVisitor::VisitBody(IfStatement &if_statement) {
+    frames_.push_back({if_statement.body, 0, &if_statement, false});
+}
+
+void IterativeVisitor::VisitBody(WhileStatement &while_statement) {
+    frames_.push_back({while_statement.body, 0, &while_statement, true});
+}
+
+void IterativeVisitor::Visit(StatementList &sl) {
+    const auto base = frames_.size();
+    frames_.push_back({sl, 0, nullptr, false});
+    while (frames_.size() > base) {
+        auto& frame = frames_.back();
+        if (frame.next < frame.statements.size()) {
+            // May push the frame of a body, after which `frame` is stale.
+            frame.statements[frame.next++]->Accept(*this);
+            continue;
+        }
+        auto* owner = frame.owner;
+        const bool is_loop = frame.is_loop;
+        frames_.pop_back();
+        if (owner == nullptr) {
+            continue;
+        }
+        if (is_loop) {
+            Leave(static_cast<WhileStatement&>(*owner));
+        } else {
+            Leave(static_cast<IfStatement&>(*owner));
+        }
+    }
+}
 
 std::ostream &operator<<(std::ostream &os, const Statement &statement) {
     statement.Print(os);
@@ -145,10 +232,126 @@ std::ostream &operator<<(std::ostream &os, const StatementList &list) {
 }
 
 std::ostream &operator<<(std::ostream &os, const Expression &expression) {
-    expression.Print(os);
+    if (expression.OperandCount() == 0) {
+        expression.Print(os, 0);
+        return os;
+    }
+    // The nodes being printed, with the next operand of each.
+    std::vector<std::pair<const Expression*, size_t>> stack = {{&expression, 0}};
+    while (!stack.empty()) {
+        auto& [node, part] = stack.back();
+        node->Print(os, part);
+        if (part == node->OperandCount()) {
+            stack.pop_back();
+            continue;
+        }
+        const auto* operand = node->Operand(part++);
+        stack.emplace_back(operand, 0);
+    }
     return os;
 }
 
+void Program::Clear() {
+    arena.Reset();
+    statements = {};
+    statement_count = 0;
+    assignments = {};
+}
+
 std::ostream &operator<<(std::ostream &os, const Program &program) {
-    return os << *program.statements;
+    return os << program.statements;
+}
+
+namespace {
+
+// Summarises the statements bottom-up, as their bodies are left. The spans
+// of assignments are kept as offsets until every assignment is known and the
+// final array exists.
+class Summarizer : public IterativeVisitor {
+    struct Range {
+        Statement* statement;
+        size_t begin;
+        size_t end;
+    };
+
+    Arena &arena_;
+    std::vector<Assignment*> assignments_{};
+    std::vector<Range> ranges_{};
+    // Indices in ranges_ of the statements whose bodies are being visited.
+    std::vector<size_t> open_{};
+    std::vector<Symbol> names_{};
+
+    void Open(Statement& stmt) {
+        open_.push_back(ranges_.size());
+        ranges_.push_back({&stmt, assignments_.size(), 0});
+    }
+
+    std::span<const Symbol> ToArray(const VarSet& names) {
+        names_.clear();
+        for (const auto name: names) {
+            names_.push_back(name);
+        }
+        return arena_.NewArray<Symbol>(names_);
+    }
+
+    void Close(Statement& stmt, std::span<const Symbol> condition_names, StatementList body) {
+        VarSet reads;
+        VarSet writes;
+        reads.insert_range(condition_names);
+        for (auto* nested: body) {
+            reads.insert_range(nested->reads);
+            writes.insert_range(nested->writes);
+        }
+        stmt.reads = ToArray(reads);
+        stmt.writes = ToArray(writes);
+        ranges_[open_.back()].end = assignments_.size();
+        open_.pop_back();
+    }
+
+public:
+    Summarizer(Arena &arena, uint32_t statement_count) : arena_(arena) {
+        assignments_.reserve(statement_count);
+        ranges_.reserve(statement_count);
+    }
+
+    void Visit(Assignment &stmt) override {
+        stmt.writes = std::span(&stmt.variable->name, 1);
+        ranges_.push_back({&stmt, assignments_.size(), assignments_.size() + 1});
+        assignments_.push_back(&stmt);
+    }
+
+    void Visit(IfStatement &stmt) override {
+        Open(stmt);
+        VisitBody(stmt);
+    }
+
+    void Visit(WhileStatement &stmt) override {
+        Open(stmt);
+        VisitBody(stmt);
+    }
+
+    void Leave(IfStatement &stmt) override {
+        Close(stmt, stmt.condition_names, stmt.body);
+    }
+
+    void Leave(WhileStatement &stmt) override {
+        Close(stmt, stmt.condition_names, stmt.body);
+    }
+
+    using IterativeVisitor::Visit;
+
+    void Finish(Program &program) {
+        program.assignments = program.arena.NewArray<Assignment*>(assignments_);
+        for (const auto& range: ranges_) {
+            range.statement->assignments = program.assignments.subspan(range.begin, range.end - range.begin);
+        }
+    }
+};
+
+}
+
+void Summarize(Program &program) {
+    Summarizer summarizer(program.arena, program.statement_count);
+    summarizer.Visit(program.statements);
+    summarizer.Finish(program);
 }
@@ -0,0 +1,156 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include "batch.h"
+#include "parser.h"
+#include "source.h"
+#include "thread_pool.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct FileReport {
+    std::string text;
+    std::string error;
+    double parse_ms = 0;
+    double analysis_ms = 0;
+    bool cached = false;
+    bool done = false;
+};
+
+double MillisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void Analyse(const SourceFile& file, const ProgramAnalysis& analysis, const ResultCache* cache, FileReport& report) {
+    try {
+        if (cache != nullptr) {
+            const auto lookup_start = Clock::now();
+            if (auto text = cache->Load(file.Text())) {
+                report.analysis_ms = MillisecondsSince(lookup_start);
+                report.text = std::move(*text);
+                report.cached = true;
+                return;
+            }
+        }
+        const auto parse_start = Clock::now();
+        Parser parser(file.Text());
+        auto program = parser.ParseProgram();
+        report.parse_ms = MillisecondsSince(parse_start);
+
+        const auto analysis_start = Clock::now();
+        std::ostringstream text;
+        const bool complete = analysis(*program, text);
+        report.analysis_ms = MillisecondsSince(analysis_start);
+        report.text = std::move(text).str();
+        if (cache != nullptr && complete) {
+            cache->Store(file.Text(), report.text);
+        }
+    } catch (const std::exception& e) {
+        report.error = e.what();
+    }
+}
+
+void Print(const std::string& path, const FileReport& report, std::ostream& out) {
+    out << "== " << path << " (";
+    if (!report.error.empty()) {
+        out << "error: " << report.error << ")\n";
+        return;
+    }
+    out << std::fixed << std::setprecision(3);
+    if (report.cached) {
+        out << "cache hit " << report.analysis_ms << " ms)\n" << report.text;
+        return;
+    }
+    out << "parse " << report.parse_ms << " ms, analysis " << report.analysis_ms << " ms)\n"
+        << report.text;
+}
+
+}
+
+std::vector<std::string> ExpandInputs(const std::vector<std::string>& inputs) {
+    std::vector<std::string> paths;
+    for (const auto& input: inputs) {
+        if (input == "-") {
+            for (std::string line; std::getline(std::cin, line);) {
+                if (!line.empty()) {
+                    paths.push_back(line);
+                }
+            }
+        } else if (std::filesystem::is_directory(input)) {
+            std::vector<std::string> files;
+            for (const auto& entry: std::filesystem::recursive_directory_iterator(input)) {
+                if (entry.is_regular_file()) {
+                    files.push_back(entry.path().string());
+                }
+            }
+            std::ranges::sort(files);
+            paths.insert(paths.end(), files.begin(), files.end());
+        } else {
+            paths.push_back(input);
+        }
+    }
+    return paths;
+}
+
+bool RunBatch(const std::vector<std::string>& paths,
+              size_t jobs,
+              const ProgramAnalysis& analysis,
+              const ResultCache* cache,
+              std::ostream& out) {
+    std::vector<FileReport> reports(paths.size());
+    std::mutex mutex;
+    std::condition_variable finished;
+    const auto finish = [&](FileReport& report) {
+        {
+            std::lock_guard lock(mutex);
+            report.done = true;
+        }
+        finished.notify_all();
+    };
+
+    ThreadPool pool(jobs);
+    // Bounds the number of files open and of reports waiting to be printed.
+    const size_t window = 4 * pool.Size();
+    size_t submitted = 0;
+    bool success = true;
+    for (size_t printed = 0; printed < paths.size(); ++printed) {
+        for (; submitted < paths.size() && submitted < printed + window; ++submitted) {
+            auto& report = reports[submitted];
+            std::shared_ptr<SourceFile> file;
+            try {
+                file = std::make_shared<SourceFile>(paths[submitted]);
+            } catch (const std::exception& e) {
+                report.error = e.what();
+                finish(report);
+                continue;
+            }
+            file->Prefetch();
+            pool.Submit([&, file] {
+                Analyse(*file, analysis, cache, report);
+                finish(report);
+            });
+        }
+
+        auto& report = reports[printed];
+        {
+            std::unique_lock lock(mutex);
+            finished.wait(lock, [&] { return report.done; });
+        }
+        Print(paths[printed], report, out);
+        success &= report.error.empty();
+        report = {};
+    }
+    return success;
+}
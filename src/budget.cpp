@@ -0,0 +1,29 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include "budget.h"
+#include "value_state.h"
+
+Budget::Budget(Limits limits) : limits_(limits) {
+    Restart();
+}
+
+void Budget::Restart() {
+    start_ = std::chrono::steady_clock::now();
+    start_bytes_ = ValueState::AllocatedBytes();
+    combinations_ = 0;
+    until_check_ = kCheckPeriod;
+    exhausted_ = false;
+}
+
+void Budget::Check() {
+    until_check_ = kCheckPeriod;
+    if (limits_.bytes != 0 && ValueState::AllocatedBytes() - start_bytes_ > limits_.bytes) {
+        exhausted_ = true;
+    }
+    if (limits_.time_ms != 0 && std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_).count() > limits_.time_ms) {
+        exhausted_ = true;
+    }
+}
@@ -0,0 +1,130 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include "cfg.h"
+
+namespace {
+
+// Appends the blocks of the visited statements to the graph. New blocks are
+// only ever created after the blocks that branch to them, which makes the
+// creation order a reverse post-order.
+class CfgBuilder : public IterativeVisitor {
+    Cfg& cfg_;
+    const std::vector<bool>& never_happens_;
+    const std::vector<bool>& always_happens_;
+    uint32_t current_;
+    // The condition checks of the statements whose bodies are being visited.
+    std::vector<uint32_t> checks_{};
+
+    static bool IsSet(const std::vector<bool>& facts, const Statement& stmt) {
+        return stmt.id < facts.size() && facts[stmt.id];
+    }
+
+    uint32_t NewBlock() {
+        cfg_.blocks.emplace_back();
+        return static_cast<uint32_t>(cfg_.blocks.size() - 1);
+    }
+
+    void Link(uint32_t from, uint32_t to) {
+        cfg_.blocks[from].successors.push_back(to);
+        cfg_.blocks[to].predecessors.push_back(from);
+    }
+
+    // For an if or while statement.
+    template<class Branch>
+    void SetBranch(uint32_t block, Branch& stmt, bool is_latch) {
+        cfg_.blocks[block].branch = &stmt;
+        cfg_.blocks[block].condition = stmt.condition;
+        cfg_.blocks[block].condition_names = stmt.condition_names;
+        cfg_.blocks[block].is_latch = is_latch;
+    }
+
+    // Ends the current block with a check of the statement's condition and
+    // starts the body, or returns false after pruning it.
+    template<class Branch>
+    bool BeginBody(Branch& stmt) {
+        const auto check = current_;
+        SetBranch(check, stmt, false);
+        if (IsSet(never_happens_, stmt)) {
+            cfg_.pruned.push_back(&stmt);
+            current_ = NewBlock();
+            cfg_.blocks[check].on_false = current_;
+            Link(check, current_);
+            return false;
+        }
+        current_ = NewBlock();
+        cfg_.blocks[check].on_true = current_;
+        Link(check, current_);
+        checks_.push_back(check);
+        return true;
+    }
+
+    void EndBody(Statement& stmt, uint32_t check, uint32_t after) {
+        if (!IsSet(always_happens_, stmt)) {
+            cfg_.blocks[check].on_false = after;
+            Link(check, after);
+        }
+        current_ = after;
+    }
+
+public:
+    CfgBuilder(Cfg& cfg, const std::vector<bool>& never_happens, const std::vector<bool>& always_happens)
+        : cfg_(cfg), never_happens_(never_happens), always_happens_(always_happens), current_(NewBlock()) {}
+
+    uint32_t Current() const {
+        return current_;
+    }
+
+    void Visit(Assignment& stmt) override {
+        cfg_.blocks[current_].assignments.push_back(&stmt);
+    }
+
+    void Visit(IfStatement& stmt) override {
+        if (BeginBody(stmt)) {
+            VisitBody(stmt);
+        }
+    }
+
+    void Visit(WhileStatement& stmt) override {
+        if (BeginBody(stmt)) {
+            VisitBody(stmt);
+        }
+    }
+
+    void Leave(IfStatement& stmt) override {
+        const auto check = checks_.back();
+        checks_.pop_back();
+        const auto after = NewBlock();
+        Link(current_, after);
+        EndBody(stmt, check, after);
+    }
+
+    void Leave(WhileStatement& stmt) override {
+        const auto check = checks_.back();
+        checks_.pop_back();
+        const auto latch = current_;
+        const auto after = NewBlock();
+        SetBranch(latch, stmt, true);
+        cfg_.blocks[latch].on_true = cfg_.blocks[check].on_true;
+        cfg_.blocks[latch].on_false = after;
+        Link(latch, cfg_.blocks[check].on_true);
+        Link(latch, after);
+        EndBody(stmt, check, after);
+    }
+
+    using IterativeVisitor::Visit;
+};
+
+}
+
+Cfg Cfg::Build(StatementList statements,
+               const std::vector<bool>& never_happens,
+               const std::vector<bool>& always_happens) {
+    Cfg cfg;
+    CfgBuilder builder(cfg, never_happens, always_happens);
+    builder.Visit(statements);
+    cfg.entry = 0;
+    cfg.exit = builder.Current();
+    return cfg;
+}
@@ -0,0 +1,316 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include "ast.h"
+#include "compiled_expression.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <smmintrin.h>
+#endif
+
+CompiledExpression::CompiledExpression(const Expression& expression, std::span<const Symbol> names) : names(names) {
+    // The code is the post-order of the nodes: it is emitted backwards, by a
+    // pre-order walk that takes the operands right to left, into a buffer
+    // kept between calls, and copied out reversed.
+    thread_local std::vector<const Expression*> stack;
+    thread_local std::vector<Instruction> backwards;
+    std::swap(code, backwards);
+    code.clear();
+    stack.assign(1, &expression);
+    while (!stack.empty()) {
+        const auto* node = stack.back();
+        stack.pop_back();
+        node->Compile(*this, stack);
+    }
+    backwards.assign(code.rbegin(), code.rend());
+    std::swap(code, backwards);
+    // Variables are emitted by symbol and renumbered by their position among
+    // the names, so that their values fit in arrays as small as the names.
+    size_t stack_size = 0;
+    for (auto& instruction: code) {
+        if (instruction.op == OpCode::kVariable) {
+            const auto position = std::ranges::lower_bound(names, static_cast<Symbol>(instruction.operand));
+            instruction.operand = static_cast<int>(position - names.begin());
+        }
+        if (instruction.op == OpCode::kConstant || instruction.op == OpCode::kVariable) {
+            max_stack_size = std::max(max_stack_size, ++stack_size);
+        } else {
+            --stack_size;
+        }
+    }
+}
+
+void CompiledExpression::Emit(OpCode op, int operand) {
+    code.push_back({op, operand});
+}
+
+CompiledExpression::OpCode CompiledExpression::BinaryOpCode(char operation) {
+    switch (operation) {
+        case '+':
+            return OpCode::kAdd;
+        case '-':
+            return OpCode::kSubtract;
+        case '*':
+            return OpCode::kMultiply;
+        case '/':
+            return OpCode::kDivide;
+        case '<':
+            return OpCode::kLess;
+        case '>':
+            return OpCode::kGreater;
+        default:
+            throw std::runtime_error("Unknown operation");
+    }
+}
+
+bool CompiledExpression::Evaluate(const int* variables, int* stack, int& result) const {
+    int* top = stack;
+    for (const auto& [op, operand]: code) {
+        if (op == OpCode::kConstant) {
+            *top++ = operand;
+            continue;
+        }
+        if (op == OpCode::kVariable) {
+            *top++ = variables[operand];
+            continue;
+        }
+        const int right = *--top;
+        const int left = top[-1];
+        // Wrap around on overflow instead of invoking undefined behaviour.
+        const auto l = static_cast<unsigned>(left);
+        const auto r = static_cast<unsigned>(right);
+        switch (op) {
+            case OpCode::kAdd:
+                top[-1] = static_cast<int>(l + r);
+                break;
+            case OpCode::kSubtract:
+                top[-1] = static_cast<int>(l - r);
+                break;
+            case OpCode::kMultiply:
+                top[-1] = static_cast<int>(l * r);
+                break;
+            case OpCode::kDivide:
+                if (right == 0 || (left == INT_MIN && right == -1)) {
+                    return false;
+                }
+                top[-1] = left / right;
+                break;
+            case OpCode::kLess:
+                top[-1] = left < right;
+                break;
+            case OpCode::kGreater:
+                top[-1] = left > right;
+                break;
+            default:
+                break;
+        }
+    }
+    result = stack[0];
+    return true;
+}
+
+namespace {
+
+// One SIMD register worth of int32 lanes, with a scalar fallback.
+#if defined(__AVX2__)
+struct Lanes {
+    constexpr static size_t kWidth = 8;
+    __m256i v;
+
+    static Lanes Load(const int* p) { return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))}; }
+    static Lanes Broadcast(int value) { return {_mm256_set1_epi32(value)}; }
+    void Store(int* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    Lanes operator+(Lanes o) const { return {_mm256_add_epi32(v, o.v)}; }
+    Lanes operator-(Lanes o) const { return {_mm256_sub_epi32(v, o.v)}; }
+    Lanes operator*(Lanes o) const { return {_mm256_mullo_epi32(v, o.v)}; }
+    Lanes operator<(Lanes o) const { return {_mm256_and_si256(_mm256_cmpgt_epi32(o.v, v), _mm256_set1_epi32(1))}; }
+    Lanes operator>(Lanes o) const { return {_mm256_and_si256(_mm256_cmpgt_epi32(v, o.v), _mm256_set1_epi32(1))}; }
+    bool operator==(Lanes o) const { return _mm256_movemask_epi8(_mm256_cmpeq_epi32(v, o.v)) == -1; }
+};
+#elif defined(__SSE2__)
+struct Lanes {
+    constexpr static size_t kWidth = 4;
+    __m128i v;
+
+    static Lanes Load(const int* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+    static Lanes Broadcast(int value) { return {_mm_set1_epi32(value)}; }
+    void Store(int* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    Lanes operator+(Lanes o) const { return {_mm_add_epi32(v, o.v)}; }
+    Lanes operator-(Lanes o) const { return {_mm_sub_epi32(v, o.v)}; }
+#if defined(__SSE4_1__)
+    Lanes operator*(Lanes o) const { return {_mm_mullo_epi32(v, o.v)}; }
+#else
+    Lanes operator*(Lanes o) const {
+        // Multiply the even and the odd lanes separately and interleave the low halves back.
+        const __m128i even = _mm_mul_epu32(v, o.v);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_si128(v, 4), _mm_srli_si128(o.v, 4));
+        return {_mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                   _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)))};
+    }
+#endif
+    Lanes operator<(Lanes o) const { return {_mm_and_si128(_mm_cmplt_epi32(v, o.v), _mm_set1_epi32(1))}; }
+    Lanes operator>(Lanes o) const { return {_mm_and_si128(_mm_cmpgt_epi32(v, o.v), _mm_set1_epi32(1))}; }
+    bool operator==(Lanes o) const { return _mm_movemask_epi8(_mm_cmpeq_epi32(v, o.v)) == 0xFFFF; }
+};
+#else
+struct Lanes {
+    constexpr static size_t kWidth = 1;
+    int v;
+
+    static Lanes Load(const int* p) { return {*p}; }
+    static Lanes Broadcast(int value) { return {value}; }
+    void Store(int* p) const { *p = v; }
+    Lanes operator+(Lanes o) const { return {static_cast<int>(static_cast<unsigned>(v) + static_cast<unsigned>(o.v))}; }
+    Lanes operator-(Lanes o) const { return {static_cast<int>(static_cast<unsigned>(v) - static_cast<unsigned>(o.v))}; }
+    Lanes operator*(Lanes o) const { return {static_cast<int>(static_cast<unsigned>(v) * static_cast<unsigned>(o.v))}; }
+    Lanes operator<(Lanes o) const { return {v < o.v}; }
+    Lanes operator>(Lanes o) const { return {v > o.v}; }
+    bool operator==(Lanes o) const { return v == o.v; }
+};
+#endif
+
+static_assert(CompiledExpression::kLaneCount % Lanes::kWidth == 0);
+
+template<class Op>
+void ForEachLanes(int* left, const int* right, size_t count, Op op) {
+    for (size_t i = 0; i < count; i += Lanes::kWidth) {
+        op(Lanes::Load(left + i), Lanes::Load(right + i)).Store(left + i);
+    }
+}
+
+}
+
+bool CompiledExpression::EvaluateBatch(const int* const* lanes, size_t count, int* stack) const {
+    int* top = stack;
+    for (const auto& [op, operand]: code) {
+        if (op == OpCode::kConstant) {
+            const auto value = Lanes::Broadcast(operand);
+            for (size_t i = 0; i < count; i += Lanes::kWidth) {
+                value.Store(top + i);
+            }
+            top += count;
+            continue;
+        }
+        if (op == OpCode::kVariable) {
+            std::copy_n(lanes[operand], count, top);
+            top += count;
+            continue;
+        }
+        top -= count;
+        int* left = top - count;
+        const int* right = top;
+        switch (op) {
+            case OpCode::kAdd:
+                ForEachLanes(left, right, count, [](Lanes l, Lanes r) { return l + r; });
+                break;
+            case OpCode::kSubtract:
+                ForEachLanes(left, right, count, [](Lanes l, Lanes r) { return l - r; });
+                break;
+            case OpCode::kMultiply:
+                ForEachLanes(left, right, count, [](Lanes l, Lanes r) { return l * r; });
+                break;
+            case OpCode::kDivide:
+                // There is no SIMD integer division.
+                for (size_t i = 0; i < count; ++i) {
+                    if (right[i] == 0 || (left[i] == INT_MIN && right[i] == -1)) {
+                        return false;
+                    }
+                    left[i] /= right[i];
+                }
+                break;
+            case OpCode::kLess:
+                ForEachLanes(left, right, count, [](Lanes l, Lanes r) { return l < r; });
+                break;
+            case OpCode::kGreater:
+                ForEachLanes(left, right, count, [](Lanes l, Lanes r) { return l > r; });
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+ValueSet DistinctValues(int* results, size_t count) {
+    // Most expressions evaluate to a single value, so check for that first.
+    const auto first = Lanes::Broadcast(results[0]);
+    size_t i = 0;
+    while (i + Lanes::kWidth <= count && Lanes::Load(results + i) == first) {
+        i += Lanes::kWidth;
+    }
+    while (i < count && results[i] == results[0]) {
+        ++i;
+    }
+    if (i == count) {
+        return ValueSet::Single(results[0]);
+    }
+    std::sort(results, results + count);
+    return ValueSet::FromSorted(results, std::unique(results, results + count) - results);
+}
+
+namespace {
+
+Interval MakeInterval(int64_t lo, int64_t hi) {
+    if (lo < INT_MIN || hi > INT_MAX) {
+        // Concrete evaluation wraps around, so the result may be anything.
+        return {};
+    }
+    return {static_cast<int>(lo), static_cast<int>(hi)};
+}
+
+Interval Hull(int64_t a, int64_t b, int64_t c, int64_t d) {
+    return MakeInterval(std::min({a, b, c, d}), std::max({a, b, c, d}));
+}
+
+}
+
+Interval CompiledExpression::EvaluateRange(const Interval* variables, Interval* stack) const {
+    Interval* top = stack;
+    for (const auto& [op, operand]: code) {
+        if (op == OpCode::kConstant) {
+            *top++ = {operand, operand};
+            continue;
+        }
+        if (op == OpCode::kVariable) {
+            *top++ = variables[operand];
+            continue;
+        }
+        const Interval right = *--top;
+        const Interval left = top[-1];
+        const int64_t l_lo = left.lo, l_hi = left.hi, r_lo = right.lo, r_hi = right.hi;
+        Interval& result = top[-1];
+        switch (op) {
+            case OpCode::kAdd:
+                result = MakeInterval(l_lo + r_lo, l_hi + r_hi);
+                break;
+            case OpCode::kSubtract:
+                result = MakeInterval(l_lo - r_hi, l_hi - r_lo);
+                break;
+            case OpCode::kMultiply:
+                result = Hull(l_lo * r_lo, l_lo * r_hi, l_hi * r_lo, l_hi * r_hi);
+                break;
+            case OpCode::kDivide:
+                if (r_lo <= 0 && r_hi >= 0) {
+                    result = {};
+                } else {
+                    result = Hull(l_lo / r_lo, l_lo / r_hi, l_hi / r_lo, l_hi / r_hi);
+                }
+                break;
+            case OpCode::kLess:
+                result = l_hi < r_lo ? Interval{1, 1} : l_lo >= r_hi ? Interval{0, 0} : Interval{0, 1};
+                break;
+            case OpCode::kGreater:
+                result = l_lo > r_hi ? Interval{1, 1} : l_hi <= r_lo ? Interval{0, 0} : Interval{0, 1};
+                break;
+            default:
+                break;
+        }
+    }
+    return stack[0];
+}
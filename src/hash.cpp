@@ -0,0 +1,57 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <bit>
+#include <cstring>
+#include "hash.h"
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9e3779b185ebca87;
+constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4f;
+constexpr uint64_t kPrime3 = 0x165667b19e3779f9;
+
+uint64_t Load(const char* data) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+uint64_t Round(uint64_t lane, uint64_t word) {
+    return std::rotl(lane + word * kPrime2, 31) * kPrime1;
+}
+
+// Final avalanche of MurmurHash3.
+uint64_t Mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccd;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53;
+    value ^= value >> 33;
+    return value;
+}
+
+}
+
+Hash128 HashBytes(std::string_view bytes, uint64_t seed) {
+    uint64_t lanes[4] = {seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1};
+    const char* data = bytes.data();
+    size_t left = bytes.size();
+    for (; left >= 32; data += 32, left -= 32) {
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = Round(lanes[i], Load(data + 8 * i));
+        }
+    }
+    for (int i = 0; left >= 8; data += 8, left -= 8, ++i) {
+        lanes[i] = Round(lanes[i], Load(data));
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data, left);
+    lanes[3] = Round(lanes[3], tail ^ left);
+
+    const uint64_t size = bytes.size();
+    const uint64_t a = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+    const uint64_t b = lanes[0] ^ std::rotl(lanes[1], 23) ^ std::rotl(lanes[2], 41) ^ std::rotl(lanes[3], 53);
+    return {Mix(a ^ size * kPrime3), Mix(b + a * kPrime1 + size)};
+}
@@ -0,0 +1,131 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <stdexcept>
+#include "incremental.h"
+#include "statistics.h"
+
+IncrementalAnalyser::IncrementalAnalyser(ValueDomain domain) {
+    possible_value_analyzer_.domain = domain;
+}
+
+IncrementalAnalyser::UpdateStats IncrementalAnalyser::Update(std::string_view source) {
+    std::vector<TopLevelStatement> top_level;
+    Parser parser(source, symbols_);
+    auto program = parser.ParseProgram(top_level);
+
+    // The statements outside of the common prefix and suffix changed.
+    const size_t old_count = entries_.size();
+    const size_t new_count = top_level.size();
+    size_t prefix = 0;
+    while (prefix < old_count && prefix < new_count
+           && entries_[prefix].top_level.SameTokens(top_level[prefix])) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < old_count - prefix && suffix < new_count - prefix
+           && entries_[old_count - 1 - suffix].top_level.SameTokens(top_level[new_count - 1 - suffix])) {
+        ++suffix;
+    }
+
+    auto state = prefix < old_count ? entries_[prefix].before : end_;
+    const auto first = entries_.begin() + static_cast<ptrdiff_t>(prefix);
+    entries_.erase(first, entries_.begin() + static_cast<ptrdiff_t>(old_count - suffix));
+    entries_.insert(entries_.begin() + static_cast<ptrdiff_t>(prefix), new_count - suffix - prefix, Entry{});
+    for (size_t i = 0; i < new_count; ++i) {
+        entries_[i].top_level = std::move(top_level[i]);
+    }
+    program_ = std::move(program);
+
+    UpdateStats stats;
+    size_t forward_end = prefix;
+    for (; forward_end < new_count; ++forward_end) {
+        auto& entry = entries_[forward_end];
+        if (forward_end >= new_count - suffix && entry.before == state) {
+            break;
+        }
+        AnalyseForward(entry, state);
+        ++stats.forward;
+    }
+    if (forward_end == new_count) {
+        end_ = std::move(state);
+    }
+
+    // Everything from forward_end on is as before, including the names live
+    // at its start.
+    auto live = forward_end < new_count ? entries_[forward_end].live_before : VarSet{};
+    for (size_t i = forward_end; i-- > 0;) {
+        auto& entry = entries_[i];
+        if (i < prefix && entry.live_after == live) {
+            break;
+        }
+        AnalyseBackward(entry, live);
+        ++stats.backward;
+    }
+    return stats;
+}
+
+void IncrementalAnalyser::AnalyseForward(Entry& entry, ForwardState& state) {
+    auto& analyzer = possible_value_analyzer_;
+    entry.before = std::move(state);
+    analyzer.Restore(entry.before.values);
+    analyzer.reachable = entry.before.reachable;
+    analyzer.AnalyseNext(StatementList(&entry.top_level.statement, 1), entry.top_level.statement_count);
+
+    entry.never_happens.clear();
+    entry.always_happens.clear();
+    for (uint32_t id = 0; id < entry.top_level.statement_count; ++id) {
+        if (analyzer.never_happens[id]) {
+            entry.never_happens.push_back(id);
+        }
+        if (analyzer.always_happens[id]) {
+            entry.always_happens.push_back(id);
+        }
+    }
+    state = {analyzer.Snapshot(), analyzer.reachable};
+}
+
+void IncrementalAnalyser::AnalyseBackward(Entry& entry, VarSet& live) {
+    const auto count = entry.top_level.statement_count;
+    std::vector<bool> never_happens(count);
+    std::vector<bool> always_happens(count);
+    for (const auto id: entry.never_happens) {
+        never_happens[id] = true;
+    }
+    for (const auto id: entry.always_happens) {
+        always_happens[id] = true;
+    }
+    const auto cfg = Cfg::Build(StatementList(&entry.top_level.statement, 1), never_happens, always_happens);
+
+    LiveVariableAnalyser analyser;
+    analyser.live_in_succ = live;
+    analyser.Analyse(cfg);
+    entry.live_after = live;
+    entry.unused.clear();
+    for (const auto* stmt: analyser.unused) {
+        entry.unused.push_back(stmt->id);
+    }
+    live = analyser.live_in_succ;
+    entry.live_before = live;
+}
+
+std::vector<Statement*> IncrementalAnalyser::Unused() const {
+    std::vector<Statement*> unused;
+    for (const auto& entry: entries_) {
+        if (entry.unused.empty()) {
+            continue;
+        }
+        // Collected in pre-order, which is also the order of the ids.
+        const auto assignments = entry.top_level.statement->assignments;
+        for (const auto id: entry.unused) {
+            const auto assignment = std::ranges::lower_bound(assignments, id, {}, &Statement::id);
+            if (assignment == assignments.end() || (*assignment)->id != id) {
+                throw std::logic_error("Unused assignment not found in its statement");
+            }
+            unused.push_back(*assignment);
+        }
+    }
+    return unused;
+}
@@ -2,15 +2,124 @@
 // Created by Aleksandr Govenko on 13/12/2023.
 //
 
-#include <fstream>
+#include <charconv>
+#include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
 #include <ranges>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "analysis.h"
 #include "ast.h"
+#include "batch.h"
 #include "parser.h"
+#include "result_cache.h"
+#include "server.h"
+#include "source.h"
+#include "statistics.h"
 
-void Analyze(Program &p) {
+enum class AnalyserKind {
+    // Possible values decide the branches, liveness the unused assignments.
+    kMixed,
+    // Sparse constant propagation and def-use chains over SSA form.
+    kSsa,
+};
+
+struct Options {
+    AnalyserKind analyser = AnalyserKind::kMixed;
+    ValueDomain domain = ValueDomain::kValueSet;
+    size_t jobs = std::thread::hardware_concurrency();
+    bool stream = false;
+    bool stats = false;
+    // Answers requests on stdin, or on the socket if one is given, instead
+    // of analysing inputs.
+    bool server = false;
+    std::string socket_path;
+    // Per file, for the possible values.
+    Budget::Limits budget{};
+    std::string cache_directory;
+    std::vector<std::string> inputs;
+
+    // A single file is reported on its own; anything else is a batch.
+    bool IsBatch() const {
+        return inputs.size() != 1 || inputs[0] == "-" || std::filesystem::is_directory(inputs[0]);
+    }
+};
+
+// Parses the rest of an argument starting with `prefix`, which must all be
+// the value.
+template<class T>
+bool ParseValue(std::string_view arg, std::string_view prefix, T &value) {
+    const auto text = arg.substr(prefix.size());
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+std::optional<Options> ParseOptions(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--domain=set") {
+            options.domain = ValueDomain::kValueSet;
+        } else if (arg == "--domain=interval") {
+            options.domain = ValueDomain::kInterval;
+        } else if (arg == "--analyser=mixed") {
+            options.analyser = AnalyserKind::kMixed;
+        } else if (arg == "--analyser=ssa") {
+            options.analyser = AnalyserKind::kSsa;
+        } else if (arg == "--stream") {
+            options.stream = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--server") {
+            options.server = true;
+        } else if (arg.starts_with("--server=") && arg.size() > std::string_view("--server=").size()) {
+            options.server = true;
+            options.socket_path = arg.substr(std::string_view("--server=").size());
+        } else if (arg.starts_with("--cache=") && arg.size() > std::string_view("--cache=").size()) {
+            options.cache_directory = arg.substr(std::string_view("--cache=").size());
+        } else if (arg.starts_with("--jobs=")) {
+            if (!ParseValue(arg, "--jobs=", options.jobs) || options.jobs == 0) {
+                return {};
+            }
+        } else if (arg.starts_with("--max-time=")) {
+            if (!ParseValue(arg, "--max-time=", options.budget.time_ms) || options.budget.time_ms < 0) {
+                return {};
+            }
+        } else if (arg.starts_with("--max-combinations=")) {
+            if (!ParseValue(arg, "--max-combinations=", options.budget.combinations)) {
+                return {};
+            }
+        } else if (arg.starts_with("--max-bytes=")) {
+            if (!ParseValue(arg, "--max-bytes=", options.budget.bytes)) {
+                return {};
+            }
+        } else if (!arg.starts_with("--")) {
+            options.inputs.emplace_back(arg);
+        } else {
+            return {};
+        }
+    }
+    if (options.server) {
+        if (!options.inputs.empty() || options.stream || options.stats || !options.cache_directory.empty()
+            || options.analyser != AnalyserKind::kMixed) {
+            return {};
+        }
+        return options;
+    }
+    if (options.inputs.empty()
+        || (options.stream && (options.IsBatch() || !options.cache_directory.empty() || options.analyser != AnalyserKind::kMixed))) {
+        return {};
+    }
+    return options;
+}
+
+// Returns false if the report was cut short by the budget.
+bool Analyze(Program &p, const Options &options, std::ostream &out) {
     // std::cout << "Live variables:" << std::endl;
     // LiveVariableAnalyser analyzer;
     // analyzer.Analyse(p);
@@ -26,21 +135,143 @@ void Analyze(Program &p) {
     // }
     //
     // std::cout << "Mixed analysis:" << std::endl;
+    if (options.analyser == AnalyserKind::kSsa) {
+        SsaAnalyser ssaAnalyser;
+        ssaAnalyser.Analyse(p);
+        for (const auto &statement: ssaAnalyser.unused) {
+            out << *statement << '\n';
+        }
+        return true;
+    }
     MixedAnalyser mixedAnalyser;
+    mixedAnalyser.possible_value_analyzer.domain = options.domain;
+    mixedAnalyser.possible_value_analyzer.budget = Budget(options.budget);
     mixedAnalyser.Analyse(p);
-    for (const auto &statement: mixedAnalyser.unused | std::views::reverse) {
-        std::cout << *statement << std::endl;
+    for (const auto &statement: mixedAnalyser.unused) {
+        out << *statement << '\n';
+    }
+    const auto &reduced_precision = mixedAnalyser.possible_value_analyzer.reduced_precision;
+    for (const auto *loop: reduced_precision) {
+        out << ReducedPrecisionLine(*loop) << '\n';
     }
+    return reduced_precision.empty();
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
+// Everything besides the source that the reports of Analyze depend on.
+std::string CacheConfiguration(const Options &options) {
+    std::ostringstream configuration;
+    configuration << "version=" << kAnalysisVersion
+                  << ";analyser=" << (options.analyser == AnalyserKind::kSsa ? "ssa" : "mixed")
+                  << ";domain=" << (options.domain == ValueDomain::kInterval ? "interval" : "set")
+                  << ";combinations=" << PossibleValueAnalyzer::kMaxCombinationCount
+                  << ";depth=" << PossibleValueAnalyzer::kMaxDepth
+                  << ";widening=" << PossibleValueAnalyzer::kWideningDelay;
+    const auto& budget = options.budget;
+    if (budget.time_ms != 0 || budget.combinations != 0 || budget.bytes != 0) {
+        configuration << ";max-time=" << budget.time_ms
+                      << ";max-combinations=" << budget.combinations
+                      << ";max-bytes=" << budget.bytes;
+    }
+    return std::move(configuration).str();
+}
+
+void AnalyzeStreaming(Parser &parser, const Options &options, std::ostream &out) {
+    StreamingAnalyser analyser;
+    analyser.possible_value_analyzer.domain = options.domain;
+    analyser.possible_value_analyzer.budget = Budget(options.budget);
+    while (auto *p = parser.ParseNextStatement()) {
+        analyser.Analyse(*p);
+        for (const auto &statement: analyser.unused) {
+            out << statement << '\n';
+        }
+    }
+    analyser.Finish();
+    for (const auto &statement: analyser.unused) {
+        out << statement << '\n';
+    }
+    for (const auto &line: analyser.reduced_precision) {
+        out << line << '\n';
+    }
+}
+
+int Run(const Options &options, Statistics &statistics) {
+    if (options.server) {
+        Server server(options.domain, options.budget, options.jobs);
+        if (options.socket_path.empty()) {
+            server.Serve(std::cin, std::cout);
+            return 0;
+        }
+        try {
+            server.Listen(options.socket_path);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+        }
         return 1;
     }
-    std::ifstream file(argv[1]);
-    Parser parser(file);
-    auto program = parser.ParseProgram();
-    Analyze(*program);
+    std::optional<ResultCache> cache;
+    if (!options.cache_directory.empty()) {
+        cache.emplace(options.cache_directory, CacheConfiguration(options));
+    }
+    if (options.IsBatch()) {
+        std::mutex statistics_mutex;
+        const auto analysis = [&](Program &p, std::ostream &out) {
+            if (!options.stats) {
+                return Analyze(p, options, out);
+            }
+            // Counted per file on the worker, then summed up.
+            Statistics file_statistics;
+            Statistics::current = &file_statistics;
+            const bool complete = Analyze(p, options, out);
+            Statistics::current = nullptr;
+            std::lock_guard lock(statistics_mutex);
+            statistics.Merge(file_statistics);
+            return complete;
+        };
+        const auto *cache_ptr = cache ? &*cache : nullptr;
+        return RunBatch(ExpandInputs(options.inputs), options.jobs, analysis, cache_ptr, std::cout) ? 0 : 1;
+    }
+    SourceFile file(options.inputs[0]);
+    Parser parser(file.Text());
+    if (options.stream) {
+        AnalyzeStreaming(parser, options, std::cout);
+        return 0;
+    }
+    if (!cache) {
+        auto program = parser.ParseProgram();
+        Analyze(*program, options, std::cout);
+        return 0;
+    }
+    auto report = cache->Load(file.Text());
+    if (!report) {
+        auto program = parser.ParseProgram();
+        std::ostringstream out;
+        const bool complete = Analyze(*program, options, out);
+        report = std::move(out).str();
+        if (complete) {
+            cache->Store(file.Text(), *report);
+        }
+    }
+    std::cout << *report;
     return 0;
 }
+
+int main(int argc, char *argv[]) {
+    const auto options = ParseOptions(argc, argv);
+    if (!options) {
+        std::cerr << "Usage: " << argv[0] << " [--analyser=mixed|ssa] [--domain=set|interval] [--jobs=N] [--cache=DIR] [--stats] [BUDGET] <filename>... | <directory> | -\n"
+                  << "       " << argv[0] << " [--domain=set|interval] [--stats] [BUDGET] --stream <filename>\n"
+                  << "       " << argv[0] << " [--domain=set|interval] [--jobs=N] [BUDGET] --server[=SOCKET]\n"
+                  << "BUDGET, per file: [--max-time=MS] [--max-combinations=N] [--max-bytes=N]" << std::endl;
+        return 1;
+    }
+    Statistics statistics;
+    if (options->stats) {
+        Statistics::current = &statistics;
+    }
+    const int status = Run(*options, statistics);
+    if (options->stats) {
+        statistics.WriteJson(std::cerr);
+        std::cerr << std::endl;
+    }
+    return status;
+}
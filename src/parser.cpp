@@ -2,65 +2,209 @@
 // Created by Aleksandr Lvov on 17/12/2023.
 //
 
+#include <algorithm>
 #include "parser.h"
+#include "statistics.h"
 
-Parser::Parser(std::istream& in): in_(in) {
+Parser::Parser(std::string_view source, std::shared_ptr<SymbolTable> symbols, std::unique_ptr<Program> program)
+        : source_(source),
+          symbols_(symbols != nullptr ? std::move(symbols) : std::make_shared<SymbolTable>()),
+          program_(program != nullptr ? std::move(program) : std::make_unique<Program>()) {
+    program_->Clear();
+    program_->symbols = symbols_;
     NextToken();
 }
 
-std::shared_ptr<Program> Parser::ParseProgram() {
-    return std::make_shared<Program>(ParseStatementList());
+std::unique_ptr<Program> Parser::ParseProgram() {
+    Statistics::Timer timer(&Statistics::parse_ms);
+    program_->statements = ParseStatementList();
+    program_->statement_count = next_statement_id_;
+    Summarize(*program_);
+    return std::move(program_);
 }
 
-std::shared_ptr<StatementList> Parser::ParseStatementList() {
+std::unique_ptr<Program> Parser::ParseProgram(std::vector<TopLevelStatement>& top_level) {
+    Statistics::Timer timer(&Statistics::parse_ms);
+    hash_tokens_ = true;
+    std::vector<Statement*> statements;
+    while (true) {
+        next_statement_id_ = 0;
+        token_hash_ = 0;
+        tokens_.clear();
+        auto* stmt = ParseStatement();
+        if (stmt == nullptr) {
+            break;
+        }
+        statements.push_back(stmt);
+        top_level.push_back({stmt, next_statement_id_, token_hash_, tokens_});
+        program_->statement_count = std::max(program_->statement_count, next_statement_id_);
+    }
+    hash_tokens_ = false;
+    if (statements.empty()) {
+        throw std::runtime_error("Expected statement");
+    }
+    program_->statements = program_->arena.NewArray<Statement*>(statements);
+    Summarize(*program_);
+    return std::move(program_);
+}
+
+// The encoding tells tokens apart exactly: the kind of token in the low
+// byte, and its constant, symbol or operator above it.
+void Parser::HashToken(const Token& token) {
+    uint64_t value = token.index();
+    if (const auto* constant = std::get_if<ConstantToken>(&token)) {
+        value |= static_cast<uint64_t>(static_cast<uint32_t>(constant->value)) << 8;
+    } else if (const auto* name = std::get_if<NameToken>(&token)) {
+        value |= static_cast<uint64_t>(symbols_->Intern(name->name)) << 8;
+    } else if (const auto* op = std::get_if<OperatorToken>(&token)) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(op->op)) << 8;
+    }
+    tokens_.push_back(value);
+    token_hash_ ^= value + 0x9e3779b97f4a7c15 + (token_hash_ << 6) + (token_hash_ >> 2);
+}
+
+Program* Parser::ParseNextStatement() {
+    Statistics::Timer timer(&Statistics::parse_ms);
+    program_->arena.Reset();
+    next_statement_id_ = 0;
+    auto* stmt = ParseStatement();
+    if (stmt == nullptr) {
+        if (!streaming_) {
+            throw std::runtime_error("Expected statement");
+        }
+        return nullptr;
+    }
+    streaming_ = true;
+    program_->statements = program_->arena.NewArray<Statement*>(std::span(&stmt, 1));
+    program_->statement_count = next_statement_id_;
+    Summarize(*program_);
+    return program_.get();
+}
+
+StatementList Parser::ParseStatementList() {
     const auto stmt = ParseStatement();
     if (stmt == nullptr) {
         throw std::runtime_error("Expected statement");
     }
-    std::vector<std::shared_ptr<Statement>> statements = {stmt};
+    std::vector<Statement*> statements = {stmt};
     while (auto stmt2 = ParseStatement()) {
         statements.push_back(stmt2);
     }
-    return std::make_shared<StatementList>(statements);
+    return program_->arena.NewArray<Statement*>(statements);
 }
 
-std::shared_ptr<Statement> Parser::ParseStatement() {
-    if (NameToken token; Accept(token)) {
-        Expect<AssignToken>();
-        auto expr = ParseExpression();
-        return std::make_shared<Assignment>(std::make_shared<Variable>(token.name), expr);
+// The bodies being parsed are kept on an explicit stack, with their statements
+// parsed so far, instead of the call stack.
+Statement* Parser::ParseStatement() {
+    auto& arena = program_->arena;
+    open_blocks_.clear();
+    parsed_.clear();
+    while (true) {
+        Statement* stmt = nullptr;
+        const auto id = next_statement_id_;
+        if (NameToken token; Accept(token)) {
+            ++next_statement_id_;
+            Expect<AssignToken>();
+            std::span<const Symbol> names;
+            auto expr = ParseExpression(names);
+            const auto name = symbols_->Intern(token.name);
+            stmt = arena.New<Assignment>(arena.New<Variable>(name, symbols_->Name(name).c_str()), expr);
+            stmt->id = id;
+            stmt->reads = names;
+        } else if (IfToken token; Accept(token)) {
+            ++next_statement_id_;
+            std::span<const Symbol> names;
+            auto condition = ParseExpression(names);
+            open_blocks_.push_back({false, id, condition, names, parsed_.size()});
+            continue;
+        } else if (WhileToken token; Accept(token)) {
+            ++next_statement_id_;
+            std::span<const Symbol> names;
+            auto condition = ParseExpression(names);
+            open_blocks_.push_back({true, id, condition, names, parsed_.size()});
+            continue;
+        } else if (open_blocks_.empty()) {
+            return nullptr;
+        } else {
+            // No statement starts here, so the innermost body is complete.
+            const auto block = open_blocks_.back();
+            open_blocks_.pop_back();
+            if (parsed_.size() == block.first) {
+                throw std::runtime_error("Expected statement");
+            }
+            Expect<EndToken>();
+            const auto body = arena.NewArray<Statement*>(std::span(parsed_).subspan(block.first));
+            parsed_.resize(block.first);
+            if (block.is_loop) {
+                auto* loop = arena.New<WhileStatement>(block.condition, body);
+                loop->condition_names = block.condition_names;
+                stmt = loop;
+            } else {
+                auto* branch = arena.New<IfStatement>(block.condition, body);
+                branch->condition_names = block.condition_names;
+                stmt = branch;
+            }
+            stmt->id = block.id;
+        }
+        if (open_blocks_.empty()) {
+            return stmt;
+        }
+        parsed_.push_back(stmt);
     }
-    if (IfToken token; Accept(token)) {
-        auto condition = ParseExpression();
-        auto body = ParseStatementList();
-        Expect<EndToken>();
-        return std::make_shared<IfStatement>(condition, body);
-    }
-    if (WhileToken token; Accept(token)) {
-        auto condition = ParseExpression();
-        auto body = ParseStatementList();
-        Expect<EndToken>();
-        return std::make_shared<WhileStatement>(condition, body);
-    }
-    return nullptr;
 }
 
-std::shared_ptr<Expression> Parser::ParseExpression(int min_precedence) {
-    std::shared_ptr<Expression> expr;
-    if (ConstantToken ct; Accept(ct)) {
-        expr = std::make_shared<Constant>(ct.value);
-    } else if (NameToken nt; Accept(nt)) {
-        expr = std::make_shared<Variable>(nt.name);
-    } else if (OpenParenToken pt; Accept(pt)) {
-        expr = std::make_shared<PriorityExpression>(ParseExpression());
-    }
-    if (CloseParenToken pt; Accept(pt)) {
-        return expr;
-    }
-    for (OperatorToken token; Peek<OperatorToken>(token) && token.precedence >= min_precedence;) {
-        NextToken();
-        auto right = ParseExpression(token.precedence + 1);
-        expr = std::make_shared<BinaryExpression>(expr, token.op, right);
+// Precedence climbing, with the levels that wait for an operand kept on an
+// explicit stack instead of the call stack. Each level ends at a closing
+// parenthesis right after its primary, as the recursive parser did.
+Expression* Parser::ParseExpression(std::span<const Symbol>& names, int min_precedence) {
+    auto& arena = program_->arena;
+    const auto base = open_operands_.size();
+    const auto names_base = expression_names_.size();
+    while (true) {
+        Expression* expr = nullptr;
+        if (ConstantToken ct; Accept(ct)) {
+            expr = arena.New<Constant>(ct.value);
+        } else if (NameToken nt; Accept(nt)) {
+            const auto name = symbols_->Intern(nt.name);
+            expr = arena.New<Variable>(name, symbols_->Name(name).c_str());
+            expression_names_.push_back(name);
+        } else if (OpenParenToken pt; Accept(pt)) {
+            open_operands_.push_back({nullptr, 0, min_precedence});
+            min_precedence = 0;
+            continue;
+        } else {
+            throw std::runtime_error("Expected expression");
+        }
+        // A closing parenthesis ends the level right after its primary, but
+        // not after the operand of one of its operators.
+        bool after_primary = true;
+        while (true) {
+            CloseParenToken close;
+            OperatorToken token;
+            if (!(after_primary && Accept(close)) && Peek(token) && token.precedence >= min_precedence) {
+                NextToken();
+                open_operands_.push_back({expr, token.op, min_precedence});
+                min_precedence = token.precedence + 1;
+                break;
+            }
+            // The level is done: expr is the operand the one below waits for.
+            if (open_operands_.size() == base) {
+                const auto first = expression_names_.begin() + static_cast<ptrdiff_t>(names_base);
+                std::sort(first, expression_names_.end());
+                expression_names_.erase(std::unique(first, expression_names_.end()), expression_names_.end());
+                names = arena.NewArray<Symbol>(std::span(first, expression_names_.end()));
+                expression_names_.resize(names_base);
+                return expr;
+            }
+            const auto open = open_operands_.back();
+            open_operands_.pop_back();
+            min_precedence = open.min_precedence;
+            after_primary = open.op == 0;
+            if (after_primary) {
+                expr = arena.New<PriorityExpression>(expr);
+            } else {
+                expr = arena.New<BinaryExpression>(open.left, open.op, expr);
+            }
+        }
     }
-    return expr;
 }
@@ -0,0 +1,133 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <random>
+#include "hash.h"
+#include "result_cache.h"
+
+// An entry holds the magic and format version, the size of the source and
+// the lines of the report, each as a varint length followed by its bytes.
+namespace {
+
+constexpr std::array<char, 4> kMagic = {'D', 'F', 'R', 'C'};
+
+void PutVarint(std::string& out, uint64_t value) {
+    for (; value >= 0x80; value >>= 7) {
+        out.push_back(static_cast<char>(value | 0x80));
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool GetVarint(std::string_view& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+        const auto byte = static_cast<unsigned char>(in.front());
+        in.remove_prefix(1);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string Hex(uint64_t value) {
+    constexpr std::string_view kDigits = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i, value >>= 4) {
+        hex[i] = kDigits[value & 0xf];
+    }
+    return hex;
+}
+
+// Unique across the threads and processes writing to the same directory.
+std::string TemporarySuffix() {
+    static const uint64_t process = std::random_device{}() * 0x100000001ull ^ std::random_device{}();
+    static std::atomic<uint64_t> counter = 0;
+    return ".tmp." + Hex(process) + "." + std::to_string(counter++);
+}
+
+}
+
+ResultCache::ResultCache(std::filesystem::path directory, std::string_view configuration)
+    : directory_(std::move(directory)), configuration_hash_(HashBytes(configuration, kFormatVersion).low) {}
+
+std::filesystem::path ResultCache::PathOf(std::string_view source) const {
+    const auto hash = HashBytes(source, configuration_hash_);
+    const auto name = Hex(hash.high) + Hex(hash.low);
+    return directory_ / name.substr(0, 2) / name.substr(2);
+}
+
+std::optional<std::string> ResultCache::Load(std::string_view source) const {
+    std::ifstream file(PathOf(source), std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    const std::string entry((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string_view in = entry;
+    uint64_t version = 0;
+    uint64_t source_size = 0;
+    uint64_t line_count = 0;
+    if (!in.starts_with(std::string_view(kMagic.data(), kMagic.size()))) {
+        return std::nullopt;
+    }
+    in.remove_prefix(kMagic.size());
+    if (!GetVarint(in, version) || version != kFormatVersion
+        || !GetVarint(in, source_size) || source_size != source.size()
+        || !GetVarint(in, line_count)) {
+        return std::nullopt;
+    }
+    std::string report;
+    for (uint64_t i = 0; i < line_count; ++i) {
+        uint64_t length = 0;
+        if (!GetVarint(in, length) || length > in.size()) {
+            return std::nullopt;
+        }
+        report.append(in.substr(0, length));
+        report.push_back('\n');
+        in.remove_prefix(length);
+    }
+    if (!in.empty()) {
+        return std::nullopt;
+    }
+    return report;
+}
+
+void ResultCache::Store(std::string_view source, std::string_view report) const {
+    if (!report.empty() && !report.ends_with('\n')) {
+        return;
+    }
+    std::string entry(kMagic.data(), kMagic.size());
+    PutVarint(entry, kFormatVersion);
+    PutVarint(entry, source.size());
+    PutVarint(entry, std::ranges::count(report, '\n'));
+    for (auto lines = report; !lines.empty();) {
+        const auto end = lines.find('\n');
+        PutVarint(entry, end);
+        entry.append(lines.substr(0, end));
+        lines.remove_prefix(end + 1);
+    }
+
+    const auto path = PathOf(source);
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    auto temporary = path;
+    temporary += TemporarySuffix();
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file.write(entry.data(), static_cast<std::streamsize>(entry.size())) || !file.flush()) {
+            file.close();
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+    }
+}
@@ -0,0 +1,290 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "parser.h"
+#include "server.h"
+#include "source.h"
+
+#if __has_include(<sys/socket.h>) && __has_include(<sys/un.h>)
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define DATAFLOW_HAVE_UNIX_SOCKETS 1
+#endif
+
+namespace {
+
+// What a worker thread keeps from one request to the next.
+struct Worker {
+    std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>();
+    // The last program, whose arena the next one is parsed into.
+    std::unique_ptr<Program> program{};
+    MixedAnalyser analyser{};
+};
+
+std::string Error(std::string_view message) {
+    std::string response = "error ";
+    response += message;
+    response += '\n';
+    return response;
+}
+
+#ifdef DATAFLOW_HAVE_UNIX_SOCKETS
+
+// Buffers the reads and writes of a connected socket for iostreams, and
+// closes it once done.
+class SocketBuffer : public std::streambuf {
+    int fd_;
+    std::array<char, 4096> input_{};
+    std::array<char, 4096> output_{};
+
+public:
+    explicit SocketBuffer(int fd) : fd_(fd) {
+        setp(output_.data(), output_.data() + output_.size());
+    }
+
+    SocketBuffer(const SocketBuffer&) = delete;
+
+    SocketBuffer& operator=(const SocketBuffer&) = delete;
+
+    ~SocketBuffer() override {
+        sync();
+        close(fd_);
+    }
+
+protected:
+    int_type underflow() override {
+        ssize_t size;
+        do {
+            size = read(fd_, input_.data(), input_.size());
+        } while (size < 0 && errno == EINTR);
+        if (size <= 0) {
+            return traits_type::eof();
+        }
+        setg(input_.data(), input_.data(), input_.data() + size);
+        return traits_type::to_int_type(input_[0]);
+    }
+
+    int_type overflow(int_type c) override {
+        if (sync() != 0) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        // A client that went away must not take the server down with SIGPIPE.
+#ifdef MSG_NOSIGNAL
+        constexpr int kFlags = MSG_NOSIGNAL;
+#else
+        constexpr int kFlags = 0;
+#endif
+        for (const char* data = pbase(); data < pptr();) {
+            const auto written = send(fd_, data, pptr() - data, kFlags);
+            if (written < 0 && errno != EINTR) {
+                setp(output_.data(), output_.data() + output_.size());
+                return -1;
+            }
+            data += std::max<ssize_t>(written, 0);
+        }
+        setp(output_.data(), output_.data() + output_.size());
+        return 0;
+    }
+};
+
+#endif
+
+}
+
+Server::Server(ValueDomain domain, Budget::Limits budget, size_t jobs)
+        : domain_(domain), budget_(budget), pool_(jobs) {}
+
+std::string Server::Analyse(std::string_view source) {
+    thread_local Worker worker;
+    worker.symbols->Clear();
+    Parser parser(source, worker.symbols, std::move(worker.program));
+    worker.program = parser.ParseProgram();
+
+    auto& analyser = worker.analyser;
+    analyser.possible_value_analyzer.domain = domain_;
+    analyser.possible_value_analyzer.budget = Budget(budget_);
+    analyser.Analyse(*worker.program);
+    const auto& reduced_precision = analyser.possible_value_analyzer.reduced_precision;
+    std::ostringstream response;
+    response << "ok " << analyser.unused.size() + reduced_precision.size() << '\n';
+    for (const auto* statement: analyser.unused) {
+        response << *statement << '\n';
+    }
+    for (const auto* loop: reduced_precision) {
+        response << ReducedPrecisionLine(*loop) << '\n';
+    }
+    return std::move(response).str();
+}
+
+std::string Server::OnWorker(std::function<std::string()> task) {
+    std::promise<std::string> response;
+    auto result = response.get_future();
+    {
+        std::lock_guard lock(submit_mutex_);
+        pool_.Submit([&] {
+            try {
+                response.set_value(task());
+            } catch (const std::exception& e) {
+                response.set_value(Error(e.what()));
+            } catch (...) {
+                response.set_value(Error("internal error"));
+            }
+        });
+    }
+    return result.get();
+}
+
+std::string Server::Update(IncrementalAnalyser& buffer, std::string_view source) {
+    buffer.Update(source);
+    const auto unused = buffer.Unused();
+    std::ostringstream response;
+    response << "ok " << unused.size() << '\n';
+    for (const auto* statement: unused) {
+        response << *statement << '\n';
+    }
+    return std::move(response).str();
+}
+
+void Server::Serve(std::istream& in, std::ostream& out) {
+    constexpr std::string_view kFile = "file ";
+    constexpr std::string_view kSource = "source ";
+    constexpr std::string_view kBuffer = "buffer ";
+    // The versions of the buffer of this client, created by its first
+    // buffer request.
+    std::unique_ptr<IncrementalAnalyser> buffer;
+    for (std::string line; std::getline(in, line);) {
+        std::string response;
+        // A request that fails is answered with an error, and the next one
+        // is served as usual.
+        try {
+            if (line.starts_with(kFile)) {
+                const auto path = line.substr(kFile.size());
+                response = OnWorker([&] {
+                    SourceFile file(path);
+                    return Analyse(file.Text());
+                });
+            } else if (line.starts_with(kSource) || line.starts_with(kBuffer)) {
+                const bool is_buffer = line.starts_with(kBuffer);
+                size_t length = 0;
+                const auto value = std::string_view(line).substr(is_buffer ? kBuffer.size() : kSource.size());
+                const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), length);
+                if (error != std::errc{} || end != value.data() + value.size()) {
+                    response = Error("invalid length");
+                } else if (length > kMaxSourceLength) {
+                    // Skipped unread, so that the next request is found.
+                    in.ignore(length < static_cast<size_t>(std::numeric_limits<std::streamsize>::max())
+                              ? static_cast<std::streamsize>(length)
+                              : std::numeric_limits<std::streamsize>::max());
+                    response = Error("source too large");
+                } else {
+                    std::string source(length, '\0');
+                    if (!in.read(source.data(), static_cast<std::streamsize>(length))) {
+                        return;
+                    }
+                    if (!is_buffer) {
+                        response = OnWorker([&] {
+                            return Analyse(source);
+                        });
+                    } else {
+                        if (buffer == nullptr) {
+                            buffer = std::make_unique<IncrementalAnalyser>(domain_);
+                        }
+                        response = OnWorker([&] {
+                            return Update(*buffer, source);
+                        });
+                    }
+                }
+            } else if (!line.empty()) {
+                response = Error("unknown request");
+            }
+        } catch (const std::exception& e) {
+            response = Error(e.what());
+        }
+        out << response << std::flush;
+    }
+}
+
+void Server::Listen(const std::string& path) {
+#ifdef DATAFLOW_HAVE_UNIX_SOCKETS
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Cannot create a socket");
+    }
+    // A socket left behind by an earlier server is replaced, but nothing else.
+    if (std::filesystem::is_socket(path)) {
+        unlink(path.c_str());
+    }
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || listen(fd, SOMAXCONN) != 0) {
+        const int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), "Cannot listen on " + path);
+    }
+
+    // The clients still connected, waited for before giving up.
+    std::mutex mutex;
+    std::condition_variable disconnected;
+    size_t connected = 0;
+    int error = 0;
+    while (error == 0) {
+        const int client = accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            if (errno != EINTR && errno != ECONNABORTED) {
+                error = errno;
+            }
+            continue;
+        }
+        {
+            std::lock_guard lock(mutex);
+            ++connected;
+        }
+        std::thread([&, client] {
+            {
+                SocketBuffer buffer(client);
+                std::iostream stream(&buffer);
+                Serve(stream, stream);
+            }
+            std::lock_guard lock(mutex);
+            --connected;
+            disconnected.notify_all();
+        }).detach();
+    }
+    close(fd);
+    std::unique_lock lock(mutex);
+    disconnected.wait(lock, [&] { return connected == 0; });
+    throw std::system_error(error, std::generic_category(), "Cannot accept clients on " + path);
+#else
+    throw std::runtime_error("Unix domain sockets are not supported on this platform");
+#endif
+}
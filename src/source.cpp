@@ -0,0 +1,64 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "source.h"
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DATAFLOW_HAVE_MMAP 1
+#endif
+
+SourceFile::SourceFile(const std::string& path) {
+#ifdef DATAFLOW_HAVE_MMAP
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(data);
+            size_ = st.st_size;
+            mapped_ = true;
+        }
+    }
+    close(fd);
+    if (mapped_) {
+        return;
+    }
+#endif
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    buffer_ = std::move(contents).str();
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+SourceFile::~SourceFile() {
+#ifdef DATAFLOW_HAVE_MMAP
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+void SourceFile::Prefetch() const {
+#ifdef DATAFLOW_HAVE_MMAP
+    if (mapped_) {
+        madvise(const_cast<char*>(data_), size_, MADV_WILLNEED);
+    }
+#endif
+}
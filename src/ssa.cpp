@@ -0,0 +1,518 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <utility>
+#include "compiled_expression.h"
+#include "ssa.h"
+
+namespace {
+
+constexpr uint32_t kNone = BasicBlock::kNone;
+
+// Cooper, Harvey and Kennedy: iterates over the blocks in reverse post-order,
+// which is their numbering, until the immediate dominators settle.
+std::vector<uint32_t> Dominators(const Cfg& cfg) {
+    const auto block_count = static_cast<uint32_t>(cfg.blocks.size());
+    std::vector<uint32_t> dominators(block_count, kNone);
+    dominators[cfg.entry] = cfg.entry;
+    const auto intersect = [&](uint32_t lhs, uint32_t rhs) {
+        while (lhs != rhs) {
+            while (lhs > rhs) {
+                lhs = dominators[lhs];
+            }
+            while (rhs > lhs) {
+                rhs = dominators[rhs];
+            }
+        }
+        return lhs;
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t block = 0; block < block_count; ++block) {
+            if (block == cfg.entry) {
+                continue;
+            }
+            auto dominator = kNone;
+            for (const auto predecessor: cfg.blocks[block].predecessors) {
+                if (dominators[predecessor] == kNone) {
+                    continue;
+                }
+                dominator = dominator == kNone ? predecessor : intersect(predecessor, dominator);
+            }
+            if (dominator != dominators[block]) {
+                dominators[block] = dominator;
+                changed = true;
+            }
+        }
+    }
+    dominators[cfg.entry] = kNone;
+    return dominators;
+}
+
+std::vector<std::vector<uint32_t>> DominanceFrontiers(const Cfg& cfg, const std::vector<uint32_t>& dominators) {
+    std::vector<std::vector<uint32_t>> frontiers(cfg.blocks.size());
+    for (uint32_t block = 0; block < cfg.blocks.size(); ++block) {
+        const auto& predecessors = cfg.blocks[block].predecessors;
+        if (predecessors.size() < 2 || dominators[block] == kNone) {
+            continue;
+        }
+        for (const auto predecessor: predecessors) {
+            if (predecessor != cfg.entry && dominators[predecessor] == kNone) {
+                continue;
+            }
+            for (auto runner = predecessor; runner != dominators[block]; runner = dominators[runner]) {
+                auto& frontier = frontiers[runner];
+                if (frontier.empty() || frontier.back() != block) {
+                    frontier.push_back(block);
+                }
+            }
+        }
+    }
+    return frontiers;
+}
+
+// Turns the number of items of each list into the offsets of the lists.
+void ToOffsets(std::vector<uint32_t>& counts) {
+    uint32_t offset = 0;
+    for (auto& count: counts) {
+        offset += std::exchange(count, offset);
+    }
+}
+
+// One more than the largest symbol the graph reads or writes.
+Symbol SymbolBound(const Cfg& cfg) {
+    Symbol bound = 0;
+    const auto read = [&](std::span<const Symbol> names) {
+        if (!names.empty()) {
+            bound = std::max(bound, names.back() + 1);
+        }
+    };
+    for (const auto& block: cfg.blocks) {
+        for (const auto* assignment: block.assignments) {
+            bound = std::max(bound, assignment->variable->name + 1);
+            read(assignment->reads);
+        }
+        read(block.condition_names);
+    }
+    return bound;
+}
+
+// Gives every read the value reaching it, walking the dominator tree with an
+// explicit stack and keeping the definitions in scope for each name.
+class Renamer {
+    const Cfg& cfg_;
+    Ssa& ssa_;
+    // Indexed by symbol.
+    std::vector<std::vector<uint32_t>> in_scope_;
+    std::vector<uint32_t> entry_values_;
+
+    uint32_t Current(Symbol name) {
+        const auto& scope = in_scope_[name];
+        if (!scope.empty()) {
+            return scope.back();
+        }
+        auto& entry = entry_values_[name];
+        if (entry == kNone) {
+            entry = static_cast<uint32_t>(ssa_.values.size());
+            ssa_.values.push_back({SsaValue::Kind::kEntry, name, cfg_.entry});
+        }
+        return entry;
+    }
+
+    void Read(std::span<const Symbol> names, uint32_t operand) {
+        for (const auto name: names) {
+            ssa_.operands[operand++] = Current(name);
+        }
+    }
+
+    void Enter(uint32_t block) {
+        for (const auto value: ssa_.Definitions(block)) {
+            const auto definition = ssa_.values[value];
+            if (definition.kind == SsaValue::Kind::kAssignment) {
+                Read(definition.assignment->reads, definition.first_operand);
+            }
+            in_scope_[definition.name].push_back(value);
+        }
+        auto operand = ssa_.condition_offsets[block];
+        for (const auto name: cfg_.blocks[block].condition_names) {
+            ssa_.condition_operands[operand++] = Current(name);
+        }
+        for (const auto successor: cfg_.blocks[block].successors) {
+            const auto& predecessors = cfg_.blocks[successor].predecessors;
+            for (const auto phi: ssa_.Definitions(successor)) {
+                const auto definition = ssa_.values[phi];
+                if (definition.kind != SsaValue::Kind::kPhi) {
+                    break;
+                }
+                for (size_t i = 0; i < predecessors.size(); ++i) {
+                    if (predecessors[i] == block) {
+                        ssa_.operands[definition.first_operand + i] = Current(definition.name);
+                    }
+                }
+            }
+        }
+    }
+
+    void Leave(uint32_t block) {
+        for (const auto value: ssa_.Definitions(block)) {
+            in_scope_[ssa_.values[value].name].pop_back();
+        }
+    }
+
+public:
+    Renamer(const Cfg& cfg, Ssa& ssa, Symbol symbol_bound)
+        : cfg_(cfg), ssa_(ssa), in_scope_(symbol_bound), entry_values_(symbol_bound, kNone) {}
+
+    void Run() {
+        const auto block_count = static_cast<uint32_t>(cfg_.blocks.size());
+        std::vector<uint32_t> child_offsets(block_count + 1, 0);
+        for (uint32_t block = 0; block < block_count; ++block) {
+            if (ssa_.dominators[block] != kNone) {
+                ++child_offsets[ssa_.dominators[block]];
+            }
+        }
+        ToOffsets(child_offsets);
+        std::vector<uint32_t> children(child_offsets.back());
+        auto next_child = child_offsets;
+        for (uint32_t block = 0; block < block_count; ++block) {
+            if (ssa_.dominators[block] != kNone) {
+                children[next_child[ssa_.dominators[block]]++] = block;
+            }
+        }
+
+        // A block is on the stack twice: to enter it, and below its children
+        // to leave it once they are done.
+        std::vector<std::pair<uint32_t, bool>> stack{{cfg_.entry, false}};
+        while (!stack.empty()) {
+            const auto [block, entered] = stack.back();
+            stack.pop_back();
+            if (entered) {
+                Leave(block);
+                continue;
+            }
+            Enter(block);
+            stack.emplace_back(block, true);
+            for (auto child = child_offsets[block]; child < child_offsets[block + 1]; ++child) {
+                stack.emplace_back(children[child], false);
+            }
+        }
+    }
+};
+
+// Lists, for every value, the owners of the operands that are that value.
+void ListUsers(const std::vector<uint32_t>& operands,
+               const std::vector<uint32_t>& owners,
+               size_t value_count,
+               std::vector<uint32_t>& offsets,
+               std::vector<uint32_t>& users) {
+    offsets.assign(value_count + 1, 0);
+    for (const auto value: operands) {
+        if (value != kNone) {
+            ++offsets[value];
+        }
+    }
+    ToOffsets(offsets);
+    users.resize(offsets.back());
+    auto next = offsets;
+    for (size_t i = 0; i < operands.size(); ++i) {
+        if (operands[i] != kNone) {
+            users[next[operands[i]]++] = owners[i];
+        }
+    }
+}
+
+}
+
+Ssa Ssa::Build(const Cfg& cfg) {
+    const auto block_count = static_cast<uint32_t>(cfg.blocks.size());
+    Ssa ssa;
+    ssa.dominators = Dominators(cfg);
+    const auto frontiers = DominanceFrontiers(cfg, ssa.dominators);
+
+    const auto symbol_bound = SymbolBound(cfg);
+    std::vector<std::vector<uint32_t>> assigned_in(symbol_bound);
+    VarSet names;
+    for (uint32_t block = 0; block < block_count; ++block) {
+        for (const auto* assignment: cfg.blocks[block].assignments) {
+            const auto name = assignment->variable->name;
+            auto& blocks = assigned_in[name];
+            if (blocks.empty() || blocks.back() != block) {
+                blocks.push_back(block);
+            }
+            names.insert(name);
+        }
+    }
+
+    // Phis go on the iterated dominance frontier of the blocks assigning the
+    // name, the blocks given a phi counting as assigning it in turn.
+    std::vector<std::pair<uint32_t, Symbol>> phis;
+    // The name each block was last given a phi for, so that it needs no
+    // clearing from one name to the next.
+    std::vector<Symbol> has_phi_for(block_count, kNone);
+    for (const auto name: names) {
+        auto worklist = assigned_in[name];
+        while (!worklist.empty()) {
+            const auto block = worklist.back();
+            worklist.pop_back();
+            for (const auto join: frontiers[block]) {
+                if (has_phi_for[join] != name) {
+                    has_phi_for[join] = name;
+                    phis.emplace_back(join, name);
+                    worklist.push_back(join);
+                }
+            }
+        }
+    }
+    std::ranges::stable_sort(phis, {}, &std::pair<uint32_t, Symbol>::first);
+
+    // Every definition but those on entry is known by now, so they are laid
+    // out block by block, and renaming only fills in their operands.
+    ssa.definition_offsets.assign(block_count + 1, 0);
+    ssa.condition_offsets.assign(block_count + 1, 0);
+    for (const auto& [block, name]: phis) {
+        ++ssa.definition_offsets[block];
+    }
+    for (uint32_t block = 0; block < block_count; ++block) {
+        ssa.definition_offsets[block] += static_cast<uint32_t>(cfg.blocks[block].assignments.size());
+        ssa.condition_offsets[block] = static_cast<uint32_t>(cfg.blocks[block].condition_names.size());
+    }
+    ToOffsets(ssa.definition_offsets);
+    ToOffsets(ssa.condition_offsets);
+    ssa.condition_operands.assign(ssa.condition_offsets.back(), kNone);
+    ssa.values.reserve(ssa.definition_offsets.back() + names.size());
+    ssa.definitions.reserve(ssa.definition_offsets.back());
+    const auto define = [&](SsaValue value, size_t operand_count) {
+        value.first_operand = static_cast<uint32_t>(ssa.operands.size());
+        value.operand_count = static_cast<uint32_t>(operand_count);
+        ssa.operands.resize(ssa.operands.size() + operand_count, kNone);
+        ssa.definitions.push_back(static_cast<uint32_t>(ssa.values.size()));
+        ssa.values.push_back(value);
+    };
+    auto phi = phis.begin();
+    for (uint32_t block = 0; block < block_count; ++block) {
+        for (; phi != phis.end() && phi->first == block; ++phi) {
+            define({SsaValue::Kind::kPhi, phi->second, block}, cfg.blocks[block].predecessors.size());
+        }
+        for (auto* assignment: cfg.blocks[block].assignments) {
+            define({SsaValue::Kind::kAssignment, assignment->variable->name, block, assignment},
+                   assignment->reads.size());
+        }
+    }
+
+    Renamer(cfg, ssa, symbol_bound).Run();
+
+    std::vector<uint32_t> owners(ssa.operands.size());
+    for (uint32_t value = 0; value < ssa.values.size(); ++value) {
+        const auto& definition = ssa.values[value];
+        std::fill_n(owners.begin() + definition.first_operand, definition.operand_count, value);
+    }
+    ListUsers(ssa.operands, owners, ssa.values.size(), ssa.user_offsets, ssa.users);
+    owners.resize(ssa.condition_operands.size());
+    for (uint32_t block = 0; block < block_count; ++block) {
+        std::fill(owners.begin() + ssa.condition_offsets[block], owners.begin() + ssa.condition_offsets[block + 1], block);
+    }
+    ListUsers(ssa.condition_operands, owners, ssa.values.size(), ssa.branch_offsets, ssa.branches);
+    return ssa;
+}
+
+namespace {
+
+using Lattice = SparseConstants::Lattice;
+
+Lattice Meet(const Lattice& lhs, const Lattice& rhs) {
+    if (lhs.kind == Lattice::Kind::kUndefined) {
+        return rhs;
+    }
+    if (rhs.kind == Lattice::Kind::kUndefined || lhs == rhs) {
+        return lhs;
+    }
+    return {Lattice::Kind::kOverdefined};
+}
+
+// Follows the executable edges from the entry, and the def-use chains of the
+// values that change. A value is only queued again once it was visited, so
+// straight-line code is evaluated once, in order.
+class Propagator {
+    const Cfg& cfg_;
+    const Ssa& ssa_;
+    SparseConstants& result_;
+    std::vector<uint32_t> blocks_to_visit_{};
+    std::vector<uint32_t> values_to_visit_{};
+    std::vector<bool> visited_values_{};
+    std::vector<bool> visited_branches_{};
+    std::vector<int> variables_{};
+    std::vector<int> stack_{};
+
+    // The operands are in the order of `names`, those the expression reads.
+    Lattice Evaluate(const Expression& expression, std::span<const Symbol> names, std::span<const uint32_t> operands) {
+        variables_.clear();
+        bool undefined = false;
+        for (const auto value: operands) {
+            const auto& operand = result_.values[value];
+            // Overdefined operands decide the result even while others are
+            // still undefined.
+            if (operand.kind == Lattice::Kind::kOverdefined) {
+                return operand;
+            }
+            undefined = undefined || operand.kind == Lattice::Kind::kUndefined;
+            variables_.push_back(operand.value);
+        }
+        if (undefined) {
+            return {};
+        }
+        const CompiledExpression code(expression, names);
+        stack_.resize(std::max(stack_.size(), code.max_stack_size));
+        int value = 0;
+        if (!code.Evaluate(variables_.data(), stack_.data(), value)) {
+            return {Lattice::Kind::kOverdefined};
+        }
+        return {Lattice::Kind::kConstant, value};
+    }
+
+    void Lower(uint32_t value, Lattice lattice) {
+        auto& current = result_.values[value];
+        lattice = Meet(current, lattice);
+        if (lattice == current) {
+            return;
+        }
+        current = lattice;
+        for (const auto user: ssa_.Users(value)) {
+            if (visited_values_[user]) {
+                values_to_visit_.push_back(user);
+            }
+        }
+        for (const auto block: ssa_.Branches(value)) {
+            if (visited_branches_[block]) {
+                VisitBranch(block);
+            }
+        }
+    }
+
+    void VisitValue(uint32_t value) {
+        visited_values_[value] = true;
+        const auto& definition = ssa_.values[value];
+        const auto operands = ssa_.Operands(value);
+        switch (definition.kind) {
+            case SsaValue::Kind::kEntry:
+                Lower(value, {Lattice::Kind::kOverdefined});
+                break;
+            case SsaValue::Kind::kAssignment:
+                Lower(value, Evaluate(*definition.assignment->expression, definition.assignment->reads, operands));
+                break;
+            case SsaValue::Kind::kPhi: {
+                Lattice lattice;
+                for (size_t i = 0; i < operands.size(); ++i) {
+                    if (result_.IsExecutable(definition.block, i)) {
+                        lattice = Meet(lattice, result_.values[operands[i]]);
+                    }
+                }
+                Lower(value, lattice);
+                break;
+            }
+        }
+    }
+
+    void MarkEdge(uint32_t from, uint32_t to) {
+        if (to == kNone) {
+            return;
+        }
+        const auto& predecessors = cfg_.blocks[to].predecessors;
+        for (size_t i = 0; i < predecessors.size(); ++i) {
+            const auto edge = result_.edge_offsets[to] + i;
+            if (predecessors[i] == from && !result_.executable_edges[edge]) {
+                result_.executable_edges[edge] = true;
+                blocks_to_visit_.push_back(to);
+            }
+        }
+    }
+
+    void VisitBranch(uint32_t block) {
+        visited_branches_[block] = true;
+        const auto& basic_block = cfg_.blocks[block];
+        if (basic_block.condition == nullptr) {
+            for (const auto successor: basic_block.successors) {
+                MarkEdge(block, successor);
+            }
+            return;
+        }
+        const auto condition = Evaluate(*basic_block.condition, basic_block.condition_names, ssa_.ConditionOperands(block));
+        if (condition.kind == Lattice::Kind::kUndefined) {
+            return;
+        }
+        if (condition.kind == Lattice::Kind::kOverdefined || condition.value != 0) {
+            MarkEdge(block, basic_block.on_true);
+        }
+        if (condition.kind == Lattice::Kind::kOverdefined || condition.value == 0) {
+            MarkEdge(block, basic_block.on_false);
+        }
+    }
+
+    // The whole block on the first visit; afterwards, when another edge into
+    // it became executable, only its phis.
+    void VisitBlock(uint32_t block) {
+        const bool first = !result_.executable_blocks[block];
+        result_.executable_blocks[block] = true;
+        for (const auto value: ssa_.Definitions(block)) {
+            if (!first && ssa_.values[value].kind != SsaValue::Kind::kPhi) {
+                break;
+            }
+            VisitValue(value);
+        }
+        if (first) {
+            VisitBranch(block);
+        }
+    }
+
+public:
+    Propagator(const Cfg& cfg, const Ssa& ssa, SparseConstants& result)
+        : cfg_(cfg), ssa_(ssa), result_(result),
+          visited_values_(ssa.values.size(), false), visited_branches_(cfg.blocks.size(), false) {}
+
+    void Run() {
+        for (uint32_t value = 0; value < ssa_.values.size(); ++value) {
+            if (ssa_.values[value].kind == SsaValue::Kind::kEntry) {
+                VisitValue(value);
+            }
+        }
+        blocks_to_visit_.push_back(cfg_.entry);
+        while (!blocks_to_visit_.empty() || !values_to_visit_.empty()) {
+            if (!blocks_to_visit_.empty()) {
+                const auto block = blocks_to_visit_.back();
+                blocks_to_visit_.pop_back();
+                VisitBlock(block);
+                continue;
+            }
+            const auto value = values_to_visit_.back();
+            values_to_visit_.pop_back();
+            VisitValue(value);
+        }
+    }
+};
+
+}
+
+SparseConstants SparseConstants::Propagate(const Cfg& cfg, const Ssa& ssa) {
+    SparseConstants result;
+    result.values.resize(ssa.values.size());
+    result.executable_blocks.assign(cfg.blocks.size(), false);
+    result.edge_offsets.assign(cfg.blocks.size() + 1, 0);
+    for (uint32_t block = 0; block < cfg.blocks.size(); ++block) {
+        result.edge_offsets[block] = static_cast<uint32_t>(cfg.blocks[block].predecessors.size());
+    }
+    ToOffsets(result.edge_offsets);
+    result.executable_edges.assign(result.edge_offsets.back(), false);
+    Propagator(cfg, ssa, result).Run();
+    return result;
+}
+
+bool SparseConstants::IsExecutable(const Cfg& cfg, uint32_t from, uint32_t to) const {
+    const auto& predecessors = cfg.blocks[to].predecessors;
+    for (size_t i = 0; i < predecessors.size(); ++i) {
+        if (predecessors[i] == from && IsExecutable(to, i)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,46 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <ostream>
+#include "statistics.h"
+
+constinit thread_local Statistics* Statistics::current = nullptr;
+
+void Statistics::Merge(const Statistics& other) {
+    expression_evaluations += other.expression_evaluations;
+    combinations_evaluated += other.combinations_evaluated;
+    combination_limit_hits += other.combination_limit_hits;
+    value_set_limit_hits += other.value_set_limit_hits;
+    max_loop_depth = std::max(max_loop_depth, other.max_loop_depth);
+    loop_depth_limit_hits += other.loop_depth_limit_hits;
+    loop_summaries += other.loop_summaries;
+    loop_fixpoints += other.loop_fixpoints;
+    loop_exit_reuses += other.loop_exit_reuses;
+    budget_cutoffs += other.budget_cutoffs;
+    state_copies += other.state_copies;
+    parse_ms += other.parse_ms;
+    possible_values_ms += other.possible_values_ms;
+    live_variables_ms += other.live_variables_ms;
+    ssa_ms += other.ssa_ms;
+}
+
+void Statistics::WriteJson(std::ostream& out) const {
+    out << "{\"expression_evaluations\": " << expression_evaluations
+        << ", \"combinations_evaluated\": " << combinations_evaluated
+        << ", \"combination_limit_hits\": " << combination_limit_hits
+        << ", \"value_set_limit_hits\": " << value_set_limit_hits
+        << ", \"max_loop_depth\": " << max_loop_depth
+        << ", \"loop_depth_limit_hits\": " << loop_depth_limit_hits
+        << ", \"loop_summaries\": " << loop_summaries
+        << ", \"loop_fixpoints\": " << loop_fixpoints
+        << ", \"loop_exit_reuses\": " << loop_exit_reuses
+        << ", \"budget_cutoffs\": " << budget_cutoffs
+        << ", \"state_copies\": " << state_copies
+        << ", \"parse_ms\": " << parse_ms
+        << ", \"possible_values_ms\": " << possible_values_ms
+        << ", \"live_variables_ms\": " << live_variables_ms
+        << ", \"ssa_ms\": " << ssa_ms
+        << "}";
+}
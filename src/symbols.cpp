@@ -0,0 +1,20 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include "symbols.h"
+
+Symbol SymbolTable::InternSlow(std::string_view name) {
+    if (const auto it = symbols_.find(name); it != symbols_.end()) {
+        return it->second;
+    }
+    const auto symbol = static_cast<Symbol>(names_.size());
+    symbols_.emplace(names_.emplace_back(name), symbol);
+    return symbol;
+}
+
+void SymbolTable::Clear() {
+    symbols_.clear();
+    names_.clear();
+    single_.fill(kNone);
+}
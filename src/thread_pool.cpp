@@ -0,0 +1,83 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    thread_count = std::max<size_t>(thread_count, 1);
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.emplace_back([this, i] { Run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread: threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    auto& queue = *queues_[next_queue_++ % queues_.size()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard lock(mutex_);
+        ++pending_;
+    }
+    wake_.notify_one();
+}
+
+std::optional<std::function<void()>> ThreadPool::Take(size_t index) {
+    {
+        auto& own = *queues_[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            auto task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return task;
+        }
+    }
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        auto& other = *queues_[(index + i) % queues_.size()];
+        std::lock_guard lock(other.mutex);
+        if (!other.tasks.empty()) {
+            auto task = std::move(other.tasks.back());
+            other.tasks.pop_back();
+            return task;
+        }
+    }
+    return std::nullopt;
+}
+
+void ThreadPool::Run(size_t index) {
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [this] { return pending_ > 0 || stopping_; });
+            if (pending_ == 0) {
+                return;
+            }
+            --pending_;
+        }
+        // There are at least as many queued tasks as claims, but a scan may
+        // miss them while other workers are taking theirs.
+        auto task = Take(index);
+        while (!task) {
+            std::this_thread::yield();
+            task = Take(index);
+        }
+        (*task)();
+    }
+}
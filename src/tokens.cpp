@@ -2,51 +2,111 @@
 // Created by Aleksandr Govenko on 17/12/2023.
 //
 
-#include <iostream>
+#include <bit>
+#include <cstring>
 #include "tokens.h"
 
-std::optional<Token> NextToken(std::istream& in_) {
-    char c;
-    in_ >> c;
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+bool IsSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool IsDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+bool IsLower(char c) {
+    return static_cast<unsigned char>(c - 'a') < 26;
+}
+
+const char* SkipSpaces(const char* it, const char* end) {
+#ifdef __SSE2__
+    // Indentation comes in long runs, so skip it 16 bytes at a time.
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t' - 1);
+    const __m128i cr = _mm_set1_epi8('\r' + 1);
+    while (end - it >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        const __m128i is_space = _mm_or_si128(
+                _mm_cmpeq_epi8(chunk, space),
+                _mm_and_si128(_mm_cmpgt_epi8(chunk, tab), _mm_cmplt_epi8(chunk, cr)));
+        const unsigned mask = ~_mm_movemask_epi8(is_space) & 0xFFFF;
+        if (mask != 0) {
+            return it + std::countr_zero(mask);
+        }
+        it += 16;
+    }
+#endif
+    while (it != end && IsSpace(*it)) {
+        ++it;
+    }
+    return it;
+}
+
+}
+
+std::optional<Token> NextToken(std::string_view& source) {
+    const char* end = source.data() + source.size();
+    const char* it = SkipSpaces(source.data(), end);
+    if (it == end) {
+        source = {};
+        return {};
+    }
+    const char c = *it;
+    const auto advance = [&](const char* next) {
+        source = std::string_view(next, end - next);
+    };
     switch (c) {
         case '<':
         case '>':
+            advance(it + 1);
             return OperatorToken{.precedence = 1, .op = c};
         case '+':
         case '-':
+            advance(it + 1);
             return OperatorToken{.precedence = 2, .op = c};
         case '*':
         case '/':
+            advance(it + 1);
             return OperatorToken{.precedence = 3, .op = c};
         case '=':
+            advance(it + 1);
             return AssignToken{};
         case '(':
+            advance(it + 1);
             return OpenParenToken{};
         case ')':
+            advance(it + 1);
             return CloseParenToken{};
         default:
             break;
     }
-    if (std::isdigit(c)) {
+    if (IsDigit(c)) {
         int value = 0;
         do {
-            value = value * 10 + (c - '0');
-            c = in_.get();
-        } while (std::isdigit(c));
-        in_.unget();
+            value = value * 10 + (*it - '0');
+            ++it;
+        } while (it != end && IsDigit(*it));
+        advance(it);
         return ConstantToken{value};
     }
-    if (c >= 'a' && c <= 'z') {
-        std::string name;
+    if (IsLower(c)) {
+        const char* name = it;
         do {
-            name.push_back(c);
-            c = in_.get();
-        } while (c >= 'a' && c <= 'z');
-        in_.unget();
-        if (name == "if") return IfToken{};
-        if (name == "while") return WhileToken{};
-        if (name == "end") return EndToken{};
-        return NameToken{name.front()};
+            ++it;
+        } while (it != end && IsLower(*it));
+        advance(it);
+        const auto length = it - name;
+        if (length == 2 && std::memcmp(name, "if", 2) == 0) return IfToken{};
+        if (length == 5 && std::memcmp(name, "while", 5) == 0) return WhileToken{};
+        if (length == 3 && std::memcmp(name, "end", 3) == 0) return EndToken{};
+        return NameToken{std::string_view(name, length)};
     }
+    advance(it);
     return {};
 }
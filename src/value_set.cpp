@@ -0,0 +1,172 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <algorithm>
+#include <cstring>
+#include "hash.h"
+#include "value_set.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+ValueSet ValueSet::Bitmap(int base, uint64_t bits) {
+    ValueSet set;
+    if (bits == 0) {
+        return set;
+    }
+    const auto shift = std::countr_zero(bits);
+    set.size_ = static_cast<uint8_t>(std::popcount(bits));
+    set.bitmap_ = true;
+    set.base_ = base + shift;
+    set.bits_ = bits >> shift;
+    return set;
+}
+
+ValueSet ValueSet::FromSorted(const int* values, size_t count) {
+    if (count == 0) {
+        return {};
+    }
+    if (static_cast<int64_t>(values[count - 1]) - values[0] < kBitmapSpan) {
+        uint64_t bits = 0;
+        for (size_t i = 0; i < count; ++i) {
+            bits |= uint64_t{1} << (values[i] - values[0]);
+        }
+        return Bitmap(values[0], bits);
+    }
+    ValueSet set;
+    set.size_ = static_cast<uint8_t>(count);
+    std::copy_n(values, count, set.values_);
+    return set;
+}
+
+ValueSet ValueSet::Single(int value) {
+    return Bitmap(value, 1);
+}
+
+ValueSet ValueSet::Consecutive(int lo, int hi) {
+    return Bitmap(lo, (uint64_t{2} << (hi - lo)) - 1);
+}
+
+bool ValueSet::contains(int value) const {
+    if (bitmap_) {
+        const auto offset = static_cast<int64_t>(value) - base_;
+        return offset >= 0 && offset < kBitmapSpan && (bits_ >> offset & 1) != 0;
+    }
+#ifdef __SSE2__
+    // Compares with four values at a time; slots past the end are masked off.
+    const __m128i needle = _mm_set1_epi32(value);
+    for (size_t i = 0; i < size_; i += 4) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values_ + i));
+        const unsigned found = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(chunk, needle)));
+        const size_t valid = std::min<size_t>(4, size_ - i);
+        if ((found & ((1u << valid) - 1)) != 0) {
+            return true;
+        }
+    }
+    return false;
+#else
+    return std::binary_search(values_, values_ + size_, value);
+#endif
+}
+
+bool ValueSet::Merge(const ValueSet& other) {
+    if (other.empty()) {
+        return true;
+    }
+    if (empty()) {
+        *this = other;
+        return true;
+    }
+    if (bitmap_ && other.bitmap_) {
+        const int lo = std::min(base_, other.base_);
+        if (static_cast<int64_t>(std::max(max(), other.max())) - lo < kBitmapSpan) {
+            const auto bits = (bits_ << (base_ - lo)) | (other.bits_ << (other.base_ - lo));
+            if (static_cast<size_t>(std::popcount(bits)) > kCapacity) {
+                return false;
+            }
+            *this = Bitmap(lo, bits);
+            return true;
+        }
+    }
+    size_t missing = 0;
+    other.ForEach([&](int value) {
+        missing += !contains(value);
+    });
+    if (size_ + missing > kCapacity) {
+        return false;
+    }
+    if (missing == 0) {
+        return true;
+    }
+    int left[kCapacity];
+    int right[kCapacity];
+    int merged[kCapacity];
+    int* end = left;
+    ForEach([&](int value) { *end++ = value; });
+    int* other_end = right;
+    other.ForEach([&](int value) { *other_end++ = value; });
+    *this = FromSorted(merged, std::set_union(left, end, right, other_end, merged) - merged);
+    return true;
+}
+
+bool ValueSet::EraseOutside(int64_t lo, int64_t hi) {
+    if (empty() || (lo <= min() && max() <= hi)) {
+        return !empty();
+    }
+    if (bitmap_) {
+        const int64_t first = std::max<int64_t>(lo - base_, 0);
+        const int64_t last = std::min<int64_t>(hi - base_, kBitmapSpan - 1);
+        if (first > last) {
+            *this = {};
+            return false;
+        }
+        const auto mask = (~uint64_t{0} >> (kBitmapSpan - 1 - (last - first))) << first;
+        *this = Bitmap(base_, bits_ & mask);
+        return !empty();
+    }
+    const auto* begin = std::lower_bound(values_, values_ + size_, lo);
+    const auto* end = std::upper_bound(begin, static_cast<const int*>(values_ + size_), hi);
+    int kept[kCapacity];
+    std::copy(begin, end, kept);
+    *this = FromSorted(kept, end - begin);
+    return !empty();
+}
+
+bool ValueSet::Includes(const ValueSet& other) const {
+    if (other.empty()) {
+        return true;
+    }
+    if (other.size_ > size_ || other.min() < min() || other.max() > max()) {
+        return false;
+    }
+    if (bitmap_ && other.bitmap_) {
+        // Both fit in the span of this set's bitmap.
+        return ((other.bits_ << (other.base_ - base_)) & ~bits_) == 0;
+    }
+    bool included = true;
+    other.ForEach([&](int value) {
+        included = included && contains(value);
+    });
+    return included;
+}
+
+uint64_t ValueSet::Hash() const {
+    const uint64_t seed = size_ * 2 + bitmap_;
+    if (bitmap_) {
+        const uint64_t words[] = {static_cast<uint32_t>(base_), bits_};
+        return HashBytes({reinterpret_cast<const char*>(words), sizeof(words)}, seed).low;
+    }
+    return HashBytes({reinterpret_cast<const char*>(values_), size_ * sizeof(int)}, seed).low;
+}
+
+bool ValueSet::operator==(const ValueSet& other) const {
+    if (size_ != other.size_ || bitmap_ != other.bitmap_) {
+        return false;
+    }
+    if (bitmap_) {
+        return base_ == other.base_ && bits_ == other.bits_;
+    }
+    return std::memcmp(values_, other.values_, size_ * sizeof(int)) == 0;
+}
@@ -0,0 +1,221 @@
+//
+// Created by Aleksandr Lvov on 16/10/2026.
+//
+
+#include <atomic>
+#include <bit>
+#include "value_state.h"
+
+namespace {
+
+const ValueSet kNoValues{};
+constexpr uint64_t kMultiplier = 0x9e3779b97f4a7c15;
+
+// One counter for the whole process: states are kept across requests and
+// move between threads, and stamps must tell apart the changes of any two.
+std::atomic<uint64_t> next_stamp = 1;
+
+uint64_t NextStamp() {
+    return next_stamp.fetch_add(1, std::memory_order_relaxed);
+}
+
+constinit thread_local uint64_t allocated_bytes = 0;
+
+}
+
+const ValueState::Page* ValueState::PageOf(Symbol name) const {
+    const auto page = name / kPageSize;
+    if (table_ == nullptr) {
+        return nullptr;
+    }
+    if (page == 0) {
+        return &table_->first;
+    }
+    return page <= table_->rest.size() ? table_->rest[page - 1].get() : nullptr;
+}
+
+const ValueState::Slot* ValueState::Read(Symbol name) const {
+    const auto* page = PageOf(name);
+    if (page == nullptr) {
+        return nullptr;
+    }
+    const auto& slot = page->slots[name % kPageSize];
+    return slot.kind == Kind::kUnset ? nullptr : &slot;
+}
+
+uint64_t ValueState::StampOf(Symbol name) const {
+    const auto* page = PageOf(name);
+    return page == nullptr ? 0 : page->stamps[name % kPageSize];
+}
+
+ValueState::Page& ValueState::PageFor(Symbol name) {
+    if (table_ == nullptr) {
+        table_ = std::make_shared<Table>();
+        allocated_bytes += sizeof(Table);
+    } else if (table_.use_count() > 1) {
+        table_ = std::make_shared<Table>(*table_);
+        allocated_bytes += sizeof(Table) + table_->rest.size() * sizeof(std::shared_ptr<Page>);
+    }
+    const auto index = name / kPageSize;
+    if (index == 0) {
+        return table_->first;
+    }
+    auto& rest = table_->rest;
+    if (index > rest.size()) {
+        rest.resize(index);
+    }
+    auto& page = rest[index - 1];
+    if (page == nullptr) {
+        page = std::make_shared<Page>();
+        allocated_bytes += sizeof(Page);
+    } else if (page.use_count() > 1) {
+        page = std::make_shared<Page>(*page);
+        allocated_bytes += sizeof(Page);
+    }
+    return *page;
+}
+
+ValueState::Slot& ValueState::Write(Symbol name) {
+    auto& page = PageFor(name);
+    table_->names.insert(name);
+    page.stamps[name % kPageSize] = NextStamp();
+    return page.slots[name % kPageSize];
+}
+
+ValueState::Kind ValueState::KindOf(Symbol name) const {
+    const auto* slot = Read(name);
+    return slot == nullptr ? Kind::kUnset : slot->kind;
+}
+
+const ValueSet& ValueState::Get(Symbol name) {
+    const auto* slot = Read(name);
+    if (slot == nullptr) {
+        Write(name).kind = Kind::kUnknown;
+        return kNoValues;
+    }
+    return slot->kind == Kind::kValues ? slot->values : kNoValues;
+}
+
+const ValueSet* ValueState::Find(Symbol name) const {
+    const auto* slot = Read(name);
+    if (slot == nullptr) {
+        return nullptr;
+    }
+    return slot->kind == Kind::kValues ? &slot->values : &kNoValues;
+}
+
+Interval ValueState::RangeOf(Symbol name) const {
+    const auto* slot = Read(name);
+    switch (slot == nullptr ? Kind::kUnset : slot->kind) {
+        case Kind::kValues:
+            return {slot->values.min(), slot->values.max()};
+        case Kind::kRange:
+            return slot->range;
+        default:
+            return {};
+    }
+}
+
+ValueSet& ValueState::Modify(Symbol name) {
+    return Write(name).values;
+}
+
+void ValueState::Set(Symbol name, const ValueSet& values) {
+    auto& slot = Write(name);
+    slot.kind = values.empty() ? Kind::kUnknown : Kind::kValues;
+    slot.values = values;
+}
+
+void ValueState::SetRange(Symbol name, Interval range, size_t max_values) {
+    if (static_cast<int64_t>(range.hi) - range.lo < static_cast<int64_t>(max_values)) {
+        Set(name, ValueSet::Consecutive(range.lo, range.hi));
+        return;
+    }
+    auto& slot = Write(name);
+    slot.kind = range.IsUnknown() ? Kind::kUnknown : Kind::kRange;
+    slot.range = range;
+}
+
+void ValueState::SetUnknown(Symbol name) {
+    Write(name).kind = Kind::kUnknown;
+}
+
+void ValueState::Share(Symbol name, const ValueState& other) {
+    if (SharesValues(other, name)) {
+        return;
+    }
+    const auto* other_slot = other.Read(name);
+    auto& page = PageFor(name);
+    page.slots[name % kPageSize] = other_slot == nullptr ? Slot{} : *other_slot;
+    page.stamps[name % kPageSize] = other.StampOf(name);
+    if (other_slot == nullptr) {
+        table_->names.erase(name);
+    } else {
+        table_->names.insert(name);
+    }
+}
+
+void ValueState::Clear() {
+    table_ = nullptr;
+}
+
+VarSet ValueState::Names() const {
+    return table_ == nullptr ? VarSet{} : table_->names;
+}
+
+bool ValueState::SharesValues(const ValueState& other, Symbol name) const {
+    if (table_ == other.table_) {
+        return true;
+    }
+    const auto* page = PageOf(name);
+    return page == other.PageOf(name) || StampOf(name) == other.StampOf(name);
+}
+
+bool ValueState::HoldsSame(const ValueState& other, const VarSet& names) const {
+    for (const auto name: names) {
+        if (SharesValues(other, name)) {
+            continue;
+        }
+        const auto kind = KindOf(name);
+        if (kind != other.KindOf(name)) {
+            return false;
+        }
+        if (kind == Kind::kUnset) {
+            continue;
+        }
+        const auto& slot = *Read(name);
+        const auto& other_slot = *other.Read(name);
+        if ((kind == Kind::kValues && slot.values != other_slot.values)
+            || (kind == Kind::kRange && slot.range != other_slot.range)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t ValueState::Hash(const VarSet& names) const {
+    uint64_t hash = 0;
+    for (const auto name: names) {
+        const auto kind = KindOf(name);
+        uint64_t slot = static_cast<uint64_t>(name) << 8 | static_cast<uint64_t>(kind);
+        if (kind == Kind::kValues) {
+            slot ^= Read(name)->values.Hash();
+        } else if (kind == Kind::kRange) {
+            const auto& range = Read(name)->range;
+            slot ^= (static_cast<uint64_t>(static_cast<uint32_t>(range.lo)) << 32 | static_cast<uint32_t>(range.hi)) * kMultiplier;
+        }
+        hash = std::rotl(hash, 29) ^ slot * kMultiplier;
+    }
+    return hash;
+}
+
+bool ValueState::operator==(const ValueState& other) const {
+    if (table_ == other.table_) {
+        return true;
+    }
+    return Names() == other.Names() && HoldsSame(other, Names());
+}
+
+uint64_t ValueState::AllocatedBytes() {
+    return allocated_bytes;
+}
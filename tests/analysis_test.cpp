@@ -0,0 +1,123 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <string>
+#include <vector>
+#include "cases.h"
+#include "check.h"
+#include "parser.h"
+#include "reports.h"
+
+namespace {
+
+TEST(MixedReports) {
+    for (const auto& c: kCases) {
+        Context context(std::string(c.name));
+        CHECK_EQ(Mixed(c.source), c.unused);
+    }
+}
+
+TEST(SsaReports) {
+    for (const auto& c: kCases) {
+        Context context(std::string(c.name));
+        CHECK_EQ(Ssa(c.source), c.ssa_unused);
+    }
+}
+
+// Small sets stay exact in the interval domain, so it finds the same.
+TEST(MixedIntervalReports) {
+    for (const auto& c: kCases) {
+        Context context(std::string(c.name));
+        CHECK_EQ(Mixed(c.source, ValueDomain::kInterval), c.unused);
+    }
+}
+
+// Streaming finds the same assignments, in the order it finds them.
+TEST(StreamedReports) {
+    for (const auto& c: kCases) {
+        Context context(std::string(c.name));
+        CHECK_EQ(Streamed(c.source), Sorted(c.unused));
+        CHECK_EQ(Streamed(c.source, ValueDomain::kInterval), Sorted(c.unused));
+    }
+}
+
+// Loops are solved with widening, and the loop condition bounds the variable
+// it compares: `x < 34` leaves the loop with x = 34 after any trip count.
+TEST(IntervalLoopsExitAtTheirBound) {
+    CHECK_EQ(Mixed("x = 1\n"
+                   "while (x < 34)\n"
+                   "  x = x + 1\n"
+                   "end\n"
+                   "if (x > 34)\n"
+                   "  y = 1\n"
+                   "end\n"
+                   "z = y\n", ValueDomain::kInterval),
+             Report{"y = 1", "z = y"});
+    CHECK_EQ(Mixed("x = 0\n"
+                   "while (x < 100000)\n"
+                   "  x = x + 3\n"
+                   "end\n"
+                   "if (x < 100000)\n"
+                   "  y = 1\n"
+                   "end\n"
+                   "z = y\n", ValueDomain::kInterval),
+             Report{"y = 1", "z = y"});
+}
+
+// A nest of loops `depth` deep, each stepping its own counter, with the
+// innermost one accumulating into s.
+std::string LoopNest(int depth) {
+    // Names are made of letters only.
+    const auto counter = [](int i) {
+        return std::string{'c', static_cast<char>('a' + i / 26), static_cast<char>('a' + i % 26)};
+    };
+    std::string source = "s = 0\n";
+    for (int i = 0; i < depth; ++i) {
+        source += counter(i) + " = 0\n";
+        source += "while (" + counter(i) + " < n)\n";
+    }
+    source += "s = s + 1\n";
+    for (int i = depth - 1; i >= 0; --i) {
+        source += counter(i) + " = " + counter(i) + " + 1\n";
+        source += "end\n";
+    }
+    return source + "u = s\n";
+}
+
+// Liveness takes linear time in the nesting depth: walking every body twice
+// would take 2^40 walks here.
+TEST(LivenessOfDeepLoopNests) {
+    auto program = Parser(LoopNest(40)).ParseProgram();
+    LiveVariableAnalyser analyser;
+    analyser.Analyse(*program);
+    CHECK_EQ(Lines(analyser.unused), Report{"u = s"});
+}
+
+// Facts are kept by Statement::id, the pre-order number of the statement.
+TEST(FactsByStatementId) {
+    auto program = Parser("x = 5\n"
+                          "if (x > 10)\n"
+                          "  x = 13\n"
+                          "end\n"
+                          "if (x < 10)\n"
+                          "  y = x\n"
+                          "end\n"
+                          "if (a < 10)\n"
+                          "  y = a\n"
+                          "end\n").ParseProgram();
+    CHECK_EQ(program->statement_count, 7u);
+    MixedAnalyser analyser;
+    analyser.Analyse(*program);
+    const auto& values = analyser.possible_value_analyzer;
+    CHECK_EQ(values.never_happens, std::vector<bool>{false, true, false, false, false, false, false});
+    CHECK_EQ(values.always_happens, std::vector<bool>{false, false, false, true, false, false, false});
+
+    // Constant propagation decides the same branches.
+    SsaAnalyser ssa;
+    ssa.Analyse(*program);
+    CHECK_EQ(ssa.never_happens, values.never_happens);
+    CHECK_EQ(ssa.always_happens, values.always_happens);
+}
+
+}
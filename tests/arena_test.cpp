@@ -0,0 +1,68 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <cstdint>
+#include <vector>
+#include "arena.h"
+#include "check.h"
+#include "parser.h"
+
+namespace {
+
+bool IsAligned(const void* ptr, size_t align) {
+    return reinterpret_cast<uintptr_t>(ptr) % align == 0;
+}
+
+TEST(AllocationsAreAlignedAndDistinct) {
+    Arena arena;
+    auto* byte = static_cast<char*>(arena.Allocate(1, 1));
+    auto* word = arena.New<uint64_t>(42);
+    auto* wide = arena.Allocate(64, 64);
+    CHECK(IsAligned(word, alignof(uint64_t)));
+    CHECK(IsAligned(wide, 64));
+    CHECK(static_cast<void*>(byte) != word);
+    CHECK_EQ(*word, 42u);
+}
+
+TEST(NewArrayCopiesItems) {
+    Arena arena;
+    const std::vector<int> items = {1, 2, 3};
+    const auto copy = arena.NewArray<int>(items);
+    CHECK_EQ(std::vector<int>(copy.begin(), copy.end()), items);
+    CHECK(copy.data() != items.data());
+    CHECK(arena.NewArray<int>(std::span<const int>()).empty());
+}
+
+// Allocations larger than a block get a block of their own, and the rest
+// carries on.
+TEST(AllocatesBeyondTheBlockSize) {
+    Arena arena;
+    auto* small = arena.New<int>(1);
+    auto* large = static_cast<std::byte*>(arena.Allocate(1 << 20, 16));
+    large[(1 << 20) - 1] = std::byte{7};
+    auto* after = arena.New<int>(2);
+    CHECK_EQ(*small, 1);
+    CHECK_EQ(*after, 2);
+    CHECK(large[(1 << 20) - 1] == std::byte{7});
+}
+
+TEST(ResetReusesTheBlocks) {
+    Arena arena;
+    auto* first = arena.Allocate(16, 16);
+    for (int i = 0; i < 10000; ++i) {
+        arena.New<uint64_t>(i);
+    }
+    arena.Reset();
+    CHECK_EQ(arena.Allocate(16, 16), first);
+}
+
+// A program given back to the parser is parsed into the same memory.
+TEST(ProgramsReuseTheirArena) {
+    auto program = Parser("x = 1\n").ParseProgram();
+    const auto* statement = program->statements.front();
+    program = Parser("y = 2\n", nullptr, std::move(program)).ParseProgram();
+    CHECK_EQ(static_cast<const Statement*>(program->statements.front()), statement);
+}
+
+}
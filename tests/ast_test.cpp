@@ -0,0 +1,75 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <span>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "parser.h"
+#include "reports.h"
+
+namespace {
+
+std::vector<std::string> Names(const Program& program, std::span<const Symbol> names) {
+    std::vector<std::string> result;
+    for (const auto name: names) {
+        result.push_back(program.symbols->Name(name));
+    }
+    return result;
+}
+
+Report Texts(std::span<Assignment*> assignments) {
+    Report texts;
+    for (const auto* assignment: assignments) {
+        texts.push_back(Text(*assignment));
+    }
+    return texts;
+}
+
+// Every statement sums up those nested in it, its condition included; names
+// come in increasing symbol order, which is the order they first appear in.
+TEST(StatementsSumUpTheirBodies) {
+    auto program = Parser("a = b + c\n"
+                          "if (a > d)\n"
+                          "  while (e < a)\n"
+                          "    e = e + f\n"
+                          "  end\n"
+                          "  g = 1\n"
+                          "end\n"
+                          "h = b\n").ParseProgram();
+    const auto& statements = program->statements;
+    CHECK_EQ(statements.size(), 3u);
+
+    CHECK_EQ(Names(*program, statements[0]->reads), std::vector<std::string>{"b", "c"});
+    CHECK_EQ(Names(*program, statements[0]->writes), std::vector<std::string>{"a"});
+    CHECK_EQ(Texts(statements[0]->assignments), Report{"a = b + c"});
+
+    CHECK_EQ(Names(*program, statements[1]->reads), std::vector<std::string>{"a", "d", "e", "f"});
+    CHECK_EQ(Names(*program, statements[1]->writes), std::vector<std::string>{"e", "g"});
+    CHECK_EQ(Texts(statements[1]->assignments), Report{"e = e + f", "g = 1"});
+
+    const auto& loop = *static_cast<IfStatement&>(*statements[1]).body[0];
+    CHECK_EQ(Names(*program, loop.reads), std::vector<std::string>{"a", "e", "f"});
+    CHECK_EQ(Names(*program, loop.writes), std::vector<std::string>{"e"});
+
+    CHECK_EQ(Texts(program->assignments), Report{"a = b + c", "e = e + f", "g = 1", "h = b"});
+}
+
+TEST(IdsArePreOrder) {
+    auto program = Parser("a = 1\n"
+                          "if (a > 0)\n"
+                          "  while (a < 3)\n"
+                          "    a = a + 1\n"
+                          "  end\n"
+                          "end\n"
+                          "b = a\n").ParseProgram();
+    CHECK_EQ(program->statement_count, 5u);
+    std::vector<uint32_t> ids;
+    for (const auto* assignment: program->assignments) {
+        ids.push_back(assignment->id);
+    }
+    CHECK_EQ(ids, std::vector<uint32_t>{0, 3, 4});
+}
+
+}
@@ -0,0 +1,123 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "batch.h"
+#include "check.h"
+#include "directory.h"
+#include "reports.h"
+#include "thread_pool.h"
+
+namespace {
+
+bool WriteUnused(Program& program, std::ostream& report) {
+    MixedAnalyser analyser;
+    analyser.Analyse(program);
+    for (const auto* statement: analyser.unused) {
+        report << *statement << '\n';
+    }
+    return true;
+}
+
+// The lines of the output, with the headers cut after their first word.
+Report Untimed(const std::string& output) {
+    Report lines;
+    std::istringstream in(output);
+    for (std::string line; std::getline(in, line);) {
+        const bool timed = line.starts_with("== ") && line.ends_with(" ms)");
+        lines.push_back(timed ? line.substr(0, line.find(' ', line.find('('))) : line);
+    }
+    return lines;
+}
+
+TEST(ThreadPoolRunsEveryTask) {
+    std::atomic<int> sum = 0;
+    {
+        ThreadPool pool(4);
+        for (int i = 1; i <= 1000; ++i) {
+            pool.Submit([&sum, i] { sum += i; });
+        }
+    }
+    CHECK_EQ(sum.load(), 500500);
+}
+
+TEST(DirectoriesExpandInSortedOrder) {
+    Directory directory("dataflow-batch-test-expand");
+    const auto b = directory.Write("b.txt", "");
+    const auto a = directory.Write("sub/a.txt", "");
+    const auto c = directory.Write("c.txt", "");
+    CHECK_EQ(ExpandInputs({directory.Path(), "other.txt"}), std::vector<std::string>{b, c, a, "other.txt"});
+}
+
+// The reports come in input order whichever worker finishes first.
+TEST(ReportsInInputOrder) {
+    Directory directory("dataflow-batch-test-order");
+    std::vector<std::string> paths;
+    Report expected;
+    for (int i = 0; i < 40; ++i) {
+        const auto value = std::to_string(i);
+        paths.push_back(directory.Write(value + ".txt", "x = " + value + "\nx = 1\na = x\n"));
+        expected.insert(expected.end(), {"== " + paths.back() + " (parse", "x = " + value, "a = x"});
+    }
+    std::ostringstream out;
+    CHECK(RunBatch(paths, 4, WriteUnused, nullptr, out));
+    CHECK_EQ(Untimed(std::move(out).str()), expected);
+}
+
+// A file that cannot be parsed or read is reported in place, the others
+// still are, and the batch fails.
+TEST(FailuresAreReportedInPlace) {
+    Directory directory("dataflow-batch-test-failures");
+    const auto bad = directory.Write("bad.txt", "x = \n");
+    const auto good = directory.Write("good.txt", "x = 5\nx = 6\na = x\n");
+    const auto missing = directory.Path() + "/missing.txt";
+    std::ostringstream out;
+    CHECK(!RunBatch({bad, missing, good}, 2, WriteUnused, nullptr, out));
+    const auto lines = Untimed(std::move(out).str());
+    CHECK_EQ(lines.size(), 5u);
+    if (lines.size() == 5) {
+        CHECK_EQ(lines[0], "== " + bad + " (error: Expected expression)");
+        CHECK(lines[1].starts_with("== " + missing + " (error: "));
+        CHECK_EQ(lines[2], "== " + good + " (parse");
+        CHECK_EQ(lines[3], "x = 5");
+        CHECK_EQ(lines[4], "a = x");
+    }
+}
+
+// The second run finds the reports of the first one and says so.
+TEST(CachedReportsAreReused) {
+    Directory directory("dataflow-batch-test-cache");
+    const auto path = directory.Write("good.txt", "x = 5\nx = 6\na = x\n");
+    const ResultCache cache(directory.Path() + "/cache", "version=1;analyser=mixed");
+    for (const auto* header: {" (parse", " (cache"}) {
+        std::ostringstream out;
+        CHECK(RunBatch({path}, 2, WriteUnused, &cache, out));
+        CHECK_EQ(Untimed(std::move(out).str()), Report{"== " + path + header, "x = 5", "a = x"});
+    }
+}
+
+// A report cut short by a budget depends on the load of the machine, so it
+// is analysed again on the next run.
+TEST(CutReportsAreNotCached) {
+    Directory directory("dataflow-batch-test-cut");
+    const auto path = directory.Write("program.txt", "x = 1\n");
+    const ResultCache cache(directory.Path() + "/cache", "version=1;analyser=mixed");
+    // Whether each of two runs found the report in the cache.
+    const auto lookups = [&](bool complete) {
+        Report lookups;
+        for (int run = 0; run < 2; ++run) {
+            std::ostringstream out;
+            RunBatch({path}, 1, [&](Program&, std::ostream&) { return complete; }, &cache, out);
+            lookups.emplace_back(out.str().find("(cache hit") != std::string::npos ? "hit" : "miss");
+        }
+        return lookups;
+    };
+    CHECK_EQ(lookups(false), Report{"miss", "miss"});
+    CHECK_EQ(lookups(true), Report{"miss", "hit"});
+}
+
+}
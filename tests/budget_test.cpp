@@ -0,0 +1,84 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <algorithm>
+#include <string>
+#include "budget.h"
+#include "cases.h"
+#include "check.h"
+#include "parser.h"
+#include "reports.h"
+
+namespace {
+
+TEST(CombinationsRunOutForGood) {
+    Budget budget({.combinations = 10});
+    budget.Spend(4);
+    budget.Spend(6);
+    CHECK(!budget.Exhausted());
+    budget.Spend(1);
+    CHECK(budget.Exhausted());
+    budget.Spend(0);
+    CHECK(budget.Exhausted());
+    budget.Restart();
+    CHECK(!budget.Exhausted());
+}
+
+TEST(NoLimitsNeverRunOut) {
+    Budget budget;
+    for (int i = 0; i < 100000; ++i) {
+        budget.Spend(1000);
+    }
+    CHECK(!budget.Exhausted());
+}
+
+struct Budgeted {
+    Report unused;
+    Report reduced_precision;
+};
+
+Budgeted Analyse(std::string_view source, ValueDomain domain, Budget::Limits limits) {
+    auto program = Parser(source).ParseProgram();
+    MixedAnalyser analyser;
+    analyser.possible_value_analyzer.domain = domain;
+    analyser.possible_value_analyzer.budget = Budget(limits);
+    analyser.Analyse(*program);
+    Budgeted result{Lines(analyser.unused)};
+    for (const auto* loop: analyser.possible_value_analyzer.reduced_precision) {
+        result.reduced_precision.push_back(ReducedPrecisionLine(*loop));
+    }
+    return result;
+}
+
+// Once the budget runs out, the analysis gives up precision but stays sound:
+// whatever it reports unused is unused.
+TEST(CutReportsStaySound) {
+    for (const auto& c: kCases) {
+        for (const auto domain: {ValueDomain::kValueSet, ValueDomain::kInterval}) {
+            Context context(std::string(c.name) + (domain == ValueDomain::kValueSet ? " (set)" : " (interval)"));
+            const auto budgeted = Analyse(c.source, domain, {.combinations = 1});
+            const auto full = Mixed(c.source, domain);
+            for (const auto& line: budgeted.unused) {
+                CHECK(std::ranges::find(full, line) != full.end());
+            }
+        }
+    }
+}
+
+TEST(LoopsCutShortAreListed) {
+    const auto* source = "x = 1\n"
+                         "while (x < 20)\n"
+                         "  if (x > 10)\n"
+                         "    x = x + 2\n"
+                         "  end\n"
+                         "  x = x + 1\n"
+                         "end\n"
+                         "y = x\n";
+    const auto budgeted = Analyse(source, ValueDomain::kValueSet, {.combinations = 1});
+    CHECK_EQ(budgeted.reduced_precision, Report{"reduced precision: while (x < 20)"});
+    CHECK_EQ(budgeted.unused, Report{"y = x"});
+    CHECK(Analyse(source, ValueDomain::kValueSet, {}).reduced_precision.empty());
+}
+
+}
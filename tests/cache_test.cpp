@@ -0,0 +1,59 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include "check.h"
+#include "directory.h"
+#include "result_cache.h"
+
+namespace {
+
+const char* const kSource = "x = 5\nx = 6\na = x\n";
+const char* const kReport = "x = 5\na = x\n";
+
+TEST(StoredReportsAreFound) {
+    Directory directory("dataflow-cache-test-store");
+    ResultCache cache(directory.Path(), "version=1;analyser=mixed");
+    CHECK_EQ(cache.Load(kSource), std::nullopt);
+    cache.Store(kSource, kReport);
+    CHECK_EQ(cache.Load(kSource), std::optional<std::string>(kReport));
+    // By another run on the same directory.
+    CHECK_EQ(ResultCache(directory.Path(), "version=1;analyser=mixed").Load(kSource), std::optional<std::string>(kReport));
+    cache.Store("", "");
+    CHECK_EQ(cache.Load(""), std::optional<std::string>(""));
+}
+
+TEST(OtherSourcesAndConfigurationsMiss) {
+    Directory directory("dataflow-cache-test-miss");
+    ResultCache(directory.Path(), "version=1;analyser=mixed").Store(kSource, kReport);
+    CHECK_EQ(ResultCache(directory.Path(), "version=1;analyser=mixed").Load("x = 5\n"), std::nullopt);
+    CHECK_EQ(ResultCache(directory.Path(), "version=2;analyser=mixed").Load(kSource), std::nullopt);
+    CHECK_EQ(ResultCache(directory.Path(), "version=1;analyser=ssa").Load(kSource), std::nullopt);
+}
+
+// An entry cut short, e.g. by a full disk, reads as a miss.
+TEST(DamagedEntriesMiss) {
+    Directory directory("dataflow-cache-test-damaged");
+    ResultCache cache(directory.Path(), "version=1;analyser=mixed");
+    cache.Store(kSource, kReport);
+    for (const auto& entry: std::filesystem::recursive_directory_iterator(directory.Path())) {
+        if (entry.is_regular_file()) {
+            std::filesystem::resize_file(entry.path(), entry.file_size() - 1);
+        }
+    }
+    CHECK_EQ(cache.Load(kSource), std::nullopt);
+}
+
+// Reports that do not end a line cannot be stored as lines.
+TEST(PartialLinesAreNotStored) {
+    Directory directory("dataflow-cache-test-partial");
+    ResultCache cache(directory.Path(), "version=1;analyser=mixed");
+    cache.Store(kSource, "x = 5");
+    CHECK_EQ(cache.Load(kSource), std::nullopt);
+}
+
+}
@@ -0,0 +1,202 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#pragma once
+
+#include <string_view>
+
+#include "reports.h"
+
+// The reports of the analysers on small programs with known results: the
+// examples of the README and testfile.txt, and cases that changes to the
+// analyses got wrong before.
+struct Case {
+    std::string_view name;
+    std::string_view source;
+    // Of the mixed analyser.
+    Report unused;
+    // Of the SSA analyser, which misses facts that depend on the path taken
+    // through a loop or a branch.
+    Report ssa_unused;
+};
+
+inline const Case kCases[] = {
+    {"readme never happens",
+     "x = 5\n"
+     "if (x > 10)\n"
+     "  x = 13\n"
+     "end\n",
+     {"x = 13"},
+     {"x = 13"}},
+    {"readme unknown branch",
+     "x = a\n"
+     "if (x > 10)\n"
+     "  x = 13\n"
+     "end\n",
+     {"x = 13"},
+     {"x = 13"}},
+    {"readme loop within the unrolling limit",
+     "x = 1\n"
+     "while (x < 32)\n"
+     "  x = x + 1\n"
+     "end\n"
+     "if (x > 32)\n"
+     "  y = 1\n"
+     "end\n"
+     "z = y\n",
+     {"y = 1", "z = y"},
+     {"z = y"}},
+    {"readme overwritten",
+     "x = 5\n"
+     "x = 6\n"
+     "a = x\n",
+     {"x = 5", "a = x"},
+     {"x = 5", "a = x"}},
+    {"readme combined",
+     "x = 1\n"
+     "while (x < 13)\n"
+     "  x = x + 1\n"
+     "end\n"
+     "if (x > 13)\n"
+     "  x = 5\n"
+     "end\n"
+     "a = x\n",
+     {"x = 5", "a = x"},
+     {"a = x"}},
+    {"testfile",
+     "a = 1\n"
+     "b = a\n"
+     "\n"
+     "b = 2\n"
+     "b = 3\n"
+     "c = b\n"
+     "\n"
+     "if (c > 5)\n"
+     "  c = 4\n"
+     "end\n"
+     "d = c\n"
+     "\n"
+     "if (d < 5)\n"
+     "  d = 5\n"
+     "end\n"
+     "e = d\n"
+     "\n"
+     "while (e > 10)\n"
+     "  e = 6\n"
+     "end\n"
+     "f = e\n"
+     "\n"
+     "while (f < 10)\n"
+     "  f = f + 1\n"
+     "end\n"
+     "\n"
+     "if (h + f < 7)\n"
+     "  i = 7\n"
+     "end\n"
+     "if (i < 8)\n"
+     "  i = 7\n"
+     "  j = 8\n"
+     "end\n"
+     "i = i\n"
+     "\n"
+     "x = 10\n"
+     "while (x > 9)\n"
+     "  if (x > 10)\n"
+     "    x = 10\n"
+     "  end\n"
+     "  if (x < 11)\n"
+     "    x = 9\n"
+     "  end\n"
+     "end\n"
+     "y = x\n",
+     {"b = a", "b = 2", "c = 4", "e = 6", "j = 8", "i = i", "x = 10", "y = x"},
+     {"b = a", "b = 2", "c = 4", "e = 6", "j = 8", "i = i", "x = 10", "y = x"}},
+    {"nested loops",
+     "s = 0\n"
+     "i = 0\n"
+     "while (i < n)\n"
+     "  j = 0\n"
+     "  while (j < m)\n"
+     "    t = j\n"
+     "    s = s + j\n"
+     "    j = j + 1\n"
+     "  end\n"
+     "  i = i + 1\n"
+     "end\n"
+     "u = s\n",
+     {"t = j", "u = s"},
+     {"t = j", "u = s"}},
+    {"readme loop beyond the unrolling limit",
+     "x = 1\n"
+     "while (x < 34)\n"
+     "  x = x + 1\n"
+     "end\n"
+     "if (x > 34)\n"
+     "  y = 1\n"
+     "end\n"
+     "z = y\n",
+     {"y = 1", "z = y"},
+     {"z = y"}},
+    {"branch after a summarised loop",
+     "x = 1\n"
+     "while (x < 34)\n"
+     "  x = x + 1\n"
+     "end\n"
+     "y = 5\n"
+     "if (x < 34)\n"
+     "  y = 7\n"
+     "end\n"
+     "z = y\n",
+     {"y = 7", "z = y"},
+     {"z = y"}},
+    {"summarised loop counting down past its bound",
+     "x = 1000\n"
+     "while (x > 3)\n"
+     "  x = x - 7\n"
+     "end\n"
+     "if (x < 0)\n"
+     "  y = 1\n"
+     "end\n"
+     "z = y\n",
+     {"z = y"},
+     {"z = y"}},
+    {"loop left at a fixpoint",
+     "c = 0\n"
+     "if (a > 0)\n"
+     "  c = 1\n"
+     "end\n"
+     "y = 0\n"
+     "while (c > 0)\n"
+     "  y = 1\n"
+     "end\n"
+     "if (y > 5)\n"
+     "  z = 1\n"
+     "end\n"
+     "w = z\n",
+     {"z = 1", "w = z"},
+     {"w = z"}},
+    {"inner loop entered alike by every iteration",
+     "i = 0\n"
+     "while (i < 20)\n"
+     "  k = 3\n"
+     "  while (k > 0)\n"
+     "    k = k / 2\n"
+     "  end\n"
+     "  i = i + 1\n"
+     "end\n",
+     {},
+     {}},
+    {"branch taken in late iterations",
+     "a = 0\n"
+     "y = 1\n"
+     "while (a < 100)\n"
+     "  a = a + 1\n"
+     "  if (a > 50)\n"
+     "    y = 2\n"
+     "  end\n"
+     "end\n"
+     "z = y\n",
+     {"z = y"},
+     {"z = y"}},
+};
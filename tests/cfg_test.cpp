@@ -0,0 +1,155 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cfg.h"
+#include "check.h"
+#include "dataflow.h"
+#include "parser.h"
+#include "varset.h"
+
+namespace {
+
+const char* const kLoops = "x = 1\n"
+                           "while (x < 3)\n"
+                           "  y = x\n"
+                           "  if (y > 1)\n"
+                           "    x = x + 2\n"
+                           "  end\n"
+                           "  x = x + 1\n"
+                           "end\n"
+                           "z = y\n";
+
+// The names of the set, sorted.
+std::vector<std::string> Names(const Program& program, const VarSet& names) {
+    std::vector<std::string> result;
+    for (const auto name: names) {
+        result.push_back(program.symbols->Name(name));
+    }
+    std::ranges::sort(result);
+    return result;
+}
+
+size_t AssignmentCount(const Cfg& cfg) {
+    size_t count = 0;
+    for (const auto& block: cfg.blocks) {
+        count += block.assignments.size();
+    }
+    return count;
+}
+
+// Reverse post-order: every edge goes forwards except the back edges of the
+// loops, from their latch to the first block of their body.
+TEST(BlocksAreInReversePostOrder) {
+    auto program = Parser(kLoops).ParseProgram();
+    const auto cfg = Cfg::Build(program->statements);
+    CHECK_EQ(cfg.entry, 0u);
+    CHECK_EQ(cfg.exit, static_cast<uint32_t>(cfg.blocks.size() - 1));
+    CHECK_EQ(AssignmentCount(cfg), 5u);
+    size_t back_edges = 0;
+    for (uint32_t from = 0; from < cfg.blocks.size(); ++from) {
+        const auto& block = cfg.blocks[from];
+        for (const auto to: block.successors) {
+            const auto& predecessors = cfg.blocks[to].predecessors;
+            CHECK(std::ranges::find(predecessors, from) != predecessors.end());
+            if (Cfg::IsBackEdge(from, to)) {
+                ++back_edges;
+                CHECK(block.is_latch);
+                CHECK_EQ(to, block.on_true);
+            }
+        }
+    }
+    CHECK_EQ(back_edges, 1u);
+}
+
+TEST(NeverHappeningBodiesArePruned) {
+    auto program = Parser("x = 5\n"
+                          "if (x > 10)\n"
+                          "  x = 13\n"
+                          "end\n"
+                          "a = x\n").ParseProgram();
+    const auto cfg = Cfg::Build(program->statements, {false, true, false, false});
+    CHECK_EQ(cfg.pruned.size(), 1u);
+    CHECK_EQ(cfg.pruned.front(), program->statements[1]);
+    CHECK_EQ(AssignmentCount(cfg), 2u);
+    CHECK_EQ(cfg.blocks[cfg.entry].on_true, BasicBlock::kNone);
+    CHECK(cfg.blocks[cfg.entry].on_false != BasicBlock::kNone);
+}
+
+TEST(AlwaysHappeningBodiesCannotBeSkipped) {
+    auto program = Parser("x = 5\n"
+                          "if (x < 10)\n"
+                          "  x = 13\n"
+                          "end\n"
+                          "a = x\n").ParseProgram();
+    const auto cfg = Cfg::Build(program->statements, {}, {false, true, false, false});
+    CHECK(cfg.pruned.empty());
+    CHECK_EQ(AssignmentCount(cfg), 3u);
+    CHECK(cfg.blocks[cfg.entry].on_true != BasicBlock::kNone);
+    CHECK_EQ(cfg.blocks[cfg.entry].on_false, BasicBlock::kNone);
+    CHECK_EQ(cfg.blocks[cfg.entry].successors.size(), 1u);
+}
+
+// The names that may have been assigned, and those that may be read later:
+// the simplest problems in each direction.
+template<Direction D>
+struct NamesProblem {
+    using Value = VarSet;
+    constexpr static Direction kDirection = D;
+
+    VarSet Bottom() const {
+        return {};
+    }
+
+    VarSet Boundary() const {
+        return {};
+    }
+
+    VarSet Transfer(const BasicBlock& block, VarSet names) const {
+        for (const auto* assignment: block.assignments) {
+            if constexpr (D == Direction::kForward) {
+                names.insert(assignment->variable->name);
+            } else {
+                names.insert_range(assignment->reads);
+            }
+        }
+        if constexpr (D == Direction::kBackward) {
+            names.insert_range(block.condition_names);
+        }
+        return names;
+    }
+
+    bool Join(const BasicBlock&, VarSet& into, const VarSet& value, bool) const {
+        const auto previous = into;
+        into.merge(value);
+        return into != previous;
+    }
+};
+
+TEST(SolvesForwardsAroundLoops) {
+    auto program = Parser(kLoops).ParseProgram();
+    const auto cfg = Cfg::Build(program->statements);
+    NamesProblem<Direction::kForward> problem;
+    const auto result = Solve(cfg, problem);
+    CHECK_EQ(Names(*program, result.before[cfg.entry]), std::vector<std::string>{});
+    CHECK_EQ(Names(*program, result.after[cfg.exit]), std::vector<std::string>{"x", "y", "z"});
+    // The body is reached again along the back edge, after y is assigned.
+    const auto body = cfg.blocks[cfg.entry].on_true;
+    CHECK_EQ(Names(*program, result.before[body]), std::vector<std::string>{"x", "y"});
+}
+
+TEST(SolvesBackwardsAroundLoops) {
+    auto program = Parser(kLoops).ParseProgram();
+    const auto cfg = Cfg::Build(program->statements);
+    NamesProblem<Direction::kBackward> problem;
+    const auto result = Solve(cfg, problem);
+    CHECK_EQ(Names(*program, result.after[cfg.exit]), std::vector<std::string>{});
+    CHECK_EQ(Names(*program, result.before[cfg.exit]), std::vector<std::string>{"y"});
+    CHECK_EQ(Names(*program, result.before[cfg.entry]), std::vector<std::string>{"x", "y"});
+}
+
+}
@@ -0,0 +1,67 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "check.h"
+
+namespace {
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+// Filled in by the static initialisers of the test files.
+std::vector<Test>& Tests() {
+    static std::vector<Test> tests;
+    return tests;
+}
+
+const char* current_test = "";
+std::vector<std::string> contexts;
+int failures = 0;
+
+}
+
+bool RegisterTest(const char* name, void (*test)()) {
+    Tests().push_back({name, test});
+    return true;
+}
+
+Context::Context(std::string description) {
+    contexts.push_back(std::move(description));
+}
+
+Context::~Context() {
+    contexts.pop_back();
+}
+
+void ReportFailure(const char* file, int line, std::string_view message) {
+    ++failures;
+    std::cerr << file << ':' << line << ": FAIL " << current_test;
+    for (const auto& context: contexts) {
+        std::cerr << " / " << context;
+    }
+    std::cerr << ": " << message << std::endl;
+}
+
+int main() {
+    for (const auto& test: Tests()) {
+        current_test = test.name;
+        try {
+            test.run();
+        } catch (const std::exception& e) {
+            ReportFailure(__FILE__, __LINE__, std::string("exception: ") + e.what());
+        }
+    }
+    if (failures != 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cerr << Tests().size() << " tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,90 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#pragma once
+
+#include <exception>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Minimal test harness. TEST defines a test and registers it; CHECK and
+// CHECK_EQ report a failed check with its location and let the test go on,
+// and an exception escaping a test fails it. The main function of
+// tests/check.cpp runs every test of the executable and exits with 1 if any
+// check failed.
+bool RegisterTest(const char* name, void (*test)());
+
+void ReportFailure(const char* file, int line, std::string_view message);
+
+// Names what the checks in its scope are about, e.g. the program of a table
+// of cases, in the failures they report.
+class Context {
+public:
+    explicit Context(std::string description);
+
+    Context(const Context&) = delete;
+
+    Context& operator=(const Context&) = delete;
+
+    ~Context();
+};
+
+// Streams the value, quoting strings and listing ranges in braces.
+template<class T>
+std::string Describe(const T& value) {
+    std::ostringstream out;
+    if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        out << '"' << std::string_view(value) << '"';
+    } else if constexpr (requires { out << value; }) {
+        out << value;
+    } else if constexpr (std::ranges::range<T>) {
+        out << '{';
+        const char* separator = "";
+        for (const auto& item: value) {
+            out << separator << Describe(item);
+            separator = ", ";
+        }
+        out << '}';
+    } else {
+        out << "<unprintable>";
+    }
+    return std::move(out).str();
+}
+
+template<class T, class U>
+void CheckEqual(const T& actual, const U& expected, const char* text, const char* file, int line) {
+    if (actual == expected) {
+        return;
+    }
+    ReportFailure(file, line, std::string(text) + "\n    actual:   " + Describe(actual)
+                              + "\n    expected: " + Describe(expected));
+}
+
+#define TEST(name) \
+    void name(); \
+    [[maybe_unused]] const bool name##_registered = RegisterTest(#name, name); \
+    void name()
+
+#define CHECK(condition) \
+    ((condition) ? void() : ReportFailure(__FILE__, __LINE__, #condition))
+
+// The expected value may contain commas, as in a braced list.
+#define CHECK_EQ(actual, ...) \
+    CheckEqual((actual), (__VA_ARGS__), #actual " == " #__VA_ARGS__, __FILE__, __LINE__)
+
+#define CHECK_THROWS(statement) \
+    do { \
+        bool thrown = false; \
+        try { \
+            statement; \
+        } catch (const std::exception&) { \
+            thrown = true; \
+        } \
+        if (!thrown) { \
+            ReportFailure(__FILE__, __LINE__, "expected an exception from " #statement); \
+        } \
+    } while (false)
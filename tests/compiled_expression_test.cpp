@@ -0,0 +1,183 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <climits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "compiled_expression.h"
+#include "parser.h"
+
+std::ostream& operator<<(std::ostream& out, const Interval& range) {
+    return out << '[' << range.lo << ", " << range.hi << ']';
+}
+
+namespace {
+
+// The expression of `r = <expression>`, compiled, with the program that
+// owns its nodes and names.
+struct Compiled {
+    std::unique_ptr<Program> program;
+    CompiledExpression expression;
+
+    explicit Compiled(const std::string& expression) : program(Parser("r = " + expression + "\n").ParseProgram()) {
+        const auto& assignment = static_cast<const Assignment&>(*program->statements.front());
+        this->expression = CompiledExpression(*assignment.expression, assignment.reads);
+    }
+
+    // The values of the names, in the order of the compiled expression.
+    std::vector<int> Variables(const std::map<std::string, int>& values) const {
+        std::vector<int> variables;
+        for (const auto name: expression.names) {
+            variables.push_back(values.at(program->symbols->Name(name)));
+        }
+        return variables;
+    }
+
+    std::optional<int> Evaluate(const std::map<std::string, int>& values = {}) const {
+        const auto variables = Variables(values);
+        std::vector<int> stack(expression.max_stack_size);
+        int result = 0;
+        if (!expression.Evaluate(variables.data(), stack.data(), result)) {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    // Evaluates the combinations at once, one per lane: `combinations[i]`
+    // holds the values of the names, like for Evaluate.
+    std::optional<std::vector<int>> EvaluateBatch(const std::vector<std::map<std::string, int>>& combinations) const {
+        const auto count = combinations.size();
+        std::vector<std::vector<int>> values(expression.names.size(), std::vector<int>(count));
+        for (size_t lane = 0; lane < count; ++lane) {
+            const auto variables = Variables(combinations[lane]);
+            for (size_t i = 0; i < variables.size(); ++i) {
+                values[i][lane] = variables[i];
+            }
+        }
+        std::vector<const int*> lanes;
+        for (const auto& name_values: values) {
+            lanes.push_back(name_values.data());
+        }
+        std::vector<int> stack(expression.max_stack_size * count);
+        if (!expression.EvaluateBatch(lanes.data(), count, stack.data())) {
+            return std::nullopt;
+        }
+        return std::vector<int>(stack.begin(), stack.begin() + static_cast<ptrdiff_t>(count));
+    }
+};
+
+TEST(EvaluatesWithPrecedenceAndParentheses) {
+    CHECK_EQ(Compiled("1 + 2 * 3").Evaluate(), 7);
+    CHECK_EQ(Compiled("(1 + 2) * 3").Evaluate(), 9);
+    CHECK_EQ(Compiled("10 - 4 - 3").Evaluate(), 3);
+    CHECK_EQ(Compiled("17 / 5").Evaluate(), 3);
+    CHECK_EQ(Compiled("1 + 2 < 4").Evaluate(), 1);
+    CHECK_EQ(Compiled("2 * 3 > 6").Evaluate(), 0);
+}
+
+// Variables are read by their position among the names, whatever order the
+// expression mentions them in.
+TEST(ReadsVariablesByName) {
+    Compiled compiled("b - a * b + c");
+    CHECK_EQ(compiled.expression.names.size(), 3u);
+    CHECK_EQ(compiled.Evaluate({{"a", 2}, {"b", 5}, {"c", 1}}), -4);
+    CHECK_EQ(compiled.Evaluate({{"a", 0}, {"b", 7}, {"c", 0}}), 7);
+}
+
+TEST(UndefinedDivisionHasNoResult) {
+    CHECK_EQ(Compiled("x / 0").Evaluate({{"x", 1}}), std::nullopt);
+    CHECK_EQ(Compiled("x / y").Evaluate({{"x", INT_MIN}, {"y", -1}}), std::nullopt);
+    CHECK_EQ(Compiled("x / y").Evaluate({{"x", INT_MIN}, {"y", 1}}), INT_MIN);
+}
+
+TEST(OverflowWrapsAround) {
+    CHECK_EQ(Compiled("x + 1").Evaluate({{"x", INT_MAX}}), INT_MIN);
+    CHECK_EQ(Compiled("x * 2").Evaluate({{"x", INT_MIN}}), 0);
+}
+
+// Every lane of a batch gets the result of evaluating its combination alone,
+// including wrapped-around arithmetic and comparisons.
+TEST(BatchMatchesEvaluatingEachCombination) {
+    for (const auto* source: {"x + y * 3", "x - y", "x * y - 7", "x / (y + 100)", "x < y", "(x > y) + 2 * x"}) {
+        Context ctx(source);
+        Compiled compiled(source);
+        std::vector<std::map<std::string, int>> combinations;
+        for (int lane = 0; lane < 3 * static_cast<int>(CompiledExpression::kLaneCount); ++lane) {
+            combinations.push_back({{"x", lane * 37 - 400}, {"y", lane % 5 - 2}});
+        }
+        combinations[5]["x"] = INT_MAX;
+        combinations[6]["x"] = INT_MIN;
+        const auto batch = compiled.EvaluateBatch(combinations);
+        CHECK(batch.has_value());
+        if (!batch) {
+            continue;
+        }
+        for (size_t lane = 0; lane < combinations.size(); ++lane) {
+            Context lane_ctx("lane " + std::to_string(lane));
+            CHECK_EQ(std::optional<int>((*batch)[lane]), compiled.Evaluate(combinations[lane]));
+        }
+    }
+}
+
+// One undefined lane makes the whole batch undefined.
+TEST(BatchWithAnUndefinedLaneHasNoResult) {
+    Compiled compiled("x / y");
+    std::vector<std::map<std::string, int>> combinations(CompiledExpression::kLaneCount, {{"x", 6}, {"y", 3}});
+    CHECK(compiled.EvaluateBatch(combinations).has_value());
+    combinations.back()["y"] = 0;
+    CHECK(!compiled.EvaluateBatch(combinations).has_value());
+    combinations.back() = {{"x", INT_MIN}, {"y", -1}};
+    CHECK(!compiled.EvaluateBatch(combinations).has_value());
+}
+
+TEST(DistinctValuesOfABatch) {
+    std::vector<int> same(2 * CompiledExpression::kLaneCount + 3, 4);
+    CHECK(DistinctValues(same.data(), same.size()) == ValueSet::Single(4));
+
+    std::vector<int> mixed(same);
+    mixed.back() = -1;
+    mixed[3] = 9;
+    const auto values = DistinctValues(mixed.data(), mixed.size());
+    std::vector<int> found;
+    values.ForEach([&](int value) { found.push_back(value); });
+    CHECK_EQ(found, std::vector<int>{-1, 4, 9});
+}
+
+// The range of the expression over the ranges of its names.
+Interval Range(const std::string& source, const std::vector<Interval>& ranges) {
+    Compiled compiled(source);
+    std::vector<Interval> stack(compiled.expression.max_stack_size);
+    return compiled.expression.EvaluateRange(ranges.data(), stack.data());
+}
+
+TEST(RangesFollowIntervalArithmetic) {
+    CHECK_EQ(Range("x + 1", {{1, 5}}), Interval{2, 6});
+    CHECK_EQ(Range("x - y", {{1, 5}, {-2, 3}}), Interval{-2, 7});
+    CHECK_EQ(Range("x * y", {{-2, 3}, {-4, 5}}), Interval{-12, 15});
+    CHECK_EQ(Range("x / y", {{10, 20}, {2, 5}}), Interval{2, 10});
+    CHECK_EQ(Range("x < 34", {{1, 33}}), Interval{1, 1});
+    CHECK_EQ(Range("x < 34", {{34, 40}}), Interval{0, 0});
+    CHECK_EQ(Range("x > y", {{1, 10}, {5, 6}}), Interval{0, 1});
+}
+
+// Ranges whose concrete evaluation could wrap around, or divide by zero,
+// are unknown.
+TEST(RangesThatMayWrapAreUnknown) {
+    CHECK(Range("x + 1", {{0, INT_MAX}}).IsUnknown());
+    CHECK(Range("x * y", {{0, 1 << 20}, {0, 1 << 20}}).IsUnknown());
+    CHECK(Range("x / y", {{1, 10}, {-1, 1}}).IsUnknown());
+}
+
+TEST(StackSizeCoversTheDeepestOperands) {
+    CHECK_EQ(Compiled("1").expression.max_stack_size, 1u);
+    CHECK_EQ(Compiled("1 + 2 + 3").expression.max_stack_size, 2u);
+    CHECK_EQ(Compiled("1 + (2 + (3 + 4))").expression.max_stack_size, 4u);
+}
+
+}
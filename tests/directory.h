@@ -0,0 +1,36 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+// A directory of files for one test, removed with it.
+class Directory {
+    std::filesystem::path path_;
+
+public:
+    explicit Directory(const std::string& name) : path_(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+
+    ~Directory() {
+        std::filesystem::remove_all(path_);
+    }
+
+    std::string Write(const std::string& name, std::string_view text) const {
+        const auto file = path_ / name;
+        std::filesystem::create_directories(file.parent_path());
+        std::ofstream(file) << text;
+        return file.string();
+    }
+
+    std::string Path() const {
+        return path_.string();
+    }
+};
@@ -0,0 +1,115 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "cases.h"
+#include "check.h"
+#include "incremental.h"
+#include "reports.h"
+#include "server.h"
+
+namespace {
+
+Report Incremental(IncrementalAnalyser& analyser, std::string_view source) {
+    analyser.Update(source);
+    return Lines(analyser.Unused());
+}
+
+// The case, then the case with each line left out in turn, each followed by
+// the case restored.
+std::vector<std::string> Edits(std::string_view source) {
+    std::vector<std::string_view> lines;
+    for (auto rest = source; !rest.empty();) {
+        const auto end = rest.find('\n') + 1;
+        lines.push_back(rest.substr(0, end));
+        rest.remove_prefix(end);
+    }
+    std::vector<std::string> versions = {std::string(source)};
+    for (size_t left_out = 0; left_out < lines.size(); ++left_out) {
+        std::string version;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if (i != left_out) {
+                version += lines[i];
+            }
+        }
+        versions.push_back(std::move(version));
+        versions.emplace_back(source);
+    }
+    return versions;
+}
+
+// Every version gets the report of analysing it from scratch. Versions that
+// do not parse are rejected and leave the last one in place.
+TEST(EditsMatchWholeProgramAnalysis) {
+    for (const auto& c: kCases) {
+        for (const auto domain: {ValueDomain::kValueSet, ValueDomain::kInterval}) {
+            Context context(std::string(c.name) + (domain == ValueDomain::kValueSet ? " (set)" : " (interval)"));
+            IncrementalAnalyser analyser(domain);
+            for (const auto& version: Edits(c.source)) {
+                Report expected;
+                try {
+                    expected = Mixed(version, domain);
+                } catch (const std::runtime_error&) {
+                    CHECK_THROWS(analyser.Update(version));
+                    continue;
+                }
+                CHECK_EQ(Incremental(analyser, version), expected);
+            }
+        }
+    }
+}
+
+// Statements whose tokens and incoming state are unchanged are not analysed
+// again.
+TEST(UpdatesAnalyseWhatChanged) {
+    IncrementalAnalyser analyser;
+    auto stats = analyser.Update("a = 1\nb = a\nc = a\n");
+    CHECK_EQ(stats.forward, 3u);
+    CHECK_EQ(stats.backward, 3u);
+    stats = analyser.Update("a = 1\nb = a\nc = a\n");
+    CHECK_EQ(stats.forward, 0u);
+    CHECK_EQ(stats.backward, 0u);
+    // b keeps its value and nothing it reads changes liveness.
+    stats = analyser.Update("a = 1\nb = a + 0\nc = a\n");
+    CHECK_EQ(stats.forward, 1u);
+    CHECK_EQ(stats.backward, 1u);
+    CHECK_EQ(Lines(analyser.Unused()), Report{"b = a + 0", "c = a"});
+}
+
+TEST(BuffersAreServedAsVersions) {
+    Server server(ValueDomain::kValueSet, {}, 2);
+    CHECK_EQ(Served(server, "buffer 6\nx = 1\n"
+                            "buffer 4\nx = \n"
+                            "buffer 12\nx = 1\ny = x\n"
+                            "buffer 18\nx = 1\ny = x\nz = y\n"),
+             Report{"ok 1", "x = 1", "error Expected expression", "ok 1", "y = x", "ok 1", "z = y"});
+}
+
+// The versions of a buffer may be analysed on different workers, whose
+// states must still compare by their values. The edit flips the branch, so
+// the unchanged suffix has to be analysed again.
+TEST(BuffersOnSeveralWorkers) {
+    const std::string_view requests = "buffer 33\n"
+                                      "x = 1\n"
+                                      "if x > 5\n"
+                                      "  y = 1\n"
+                                      "end\n"
+                                      "z = y\n"
+                                      "buffer 33\n"
+                                      "x = 9\n"
+                                      "if x > 5\n"
+                                      "  y = 1\n"
+                                      "end\n"
+                                      "z = y\n";
+    for (int run = 0; run < 200; ++run) {
+        Context context("run " + std::to_string(run));
+        Server server(ValueDomain::kValueSet, {}, 4);
+        CHECK_EQ(Served(server, requests), Report{"ok 2", "y = 1", "z = y", "ok 1", "z = y"});
+    }
+}
+
+}
@@ -0,0 +1,97 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "check.h"
+#include "source.h"
+#include "tokens.h"
+
+namespace {
+
+// The tokens as text, up to the end of the input or the first character
+// that starts none.
+std::vector<std::string> Lex(std::string_view source) {
+    std::vector<std::string> tokens;
+    while (const auto token = NextToken(source)) {
+        tokens.push_back(std::visit([](const auto& t) -> std::string {
+            using T = std::decay_t<decltype(t)>;
+            if constexpr (std::is_same_v<T, ConstantToken>) {
+                return std::to_string(t.value);
+            } else if constexpr (std::is_same_v<T, NameToken>) {
+                return "name:" + std::string(t.name);
+            } else if constexpr (std::is_same_v<T, OperatorToken>) {
+                return std::string(1, t.op) + std::to_string(t.precedence);
+            } else if constexpr (std::is_same_v<T, OpenParenToken>) {
+                return "(";
+            } else if constexpr (std::is_same_v<T, CloseParenToken>) {
+                return ")";
+            } else if constexpr (std::is_same_v<T, AssignToken>) {
+                return "=";
+            } else if constexpr (std::is_same_v<T, IfToken>) {
+                return "if";
+            } else if constexpr (std::is_same_v<T, WhileToken>) {
+                return "while";
+            } else {
+                return "end";
+            }
+        }, *token));
+    }
+    return tokens;
+}
+
+TEST(LexesEveryKindOfToken) {
+    CHECK_EQ(Lex("if (x1 < 10)\n  count = count*2 - y/3 + 0\nend while"),
+             std::vector<std::string>{"if", "(", "name:x", "1", "<1", "10", ")", "name:count", "=", "name:count",
+                                      "*3", "2", "-2", "name:y", "/3", "3", "+2", "0", "end", "while"});
+}
+
+// Keywords are whole identifiers only.
+TEST(KeywordsNeedTheWholeIdentifier) {
+    CHECK_EQ(Lex("iff ending whiles if"), std::vector<std::string>{"name:iff", "name:ending", "name:whiles", "if"});
+}
+
+// Names point into the source, whatever whitespace comes before them,
+// including runs longer than a vector register.
+TEST(NamesAreViewsOfTheSource) {
+    const std::string source = std::string(40, ' ') + "\t\r\n" + std::string(17, '\n') + "abc";
+    std::string_view rest = source;
+    const auto token = NextToken(rest);
+    CHECK(token.has_value() && std::holds_alternative<NameToken>(*token));
+    if (token && std::holds_alternative<NameToken>(*token)) {
+        const auto name = std::get<NameToken>(*token).name;
+        CHECK_EQ(name, "abc");
+        CHECK_EQ(static_cast<const void*>(name.data()), static_cast<const void*>(source.data() + source.size() - 3));
+    }
+    CHECK(rest.empty());
+    CHECK(!NextToken(rest).has_value());
+}
+
+TEST(StopsAtAnUnexpectedCharacter) {
+    CHECK_EQ(Lex("x = 1 ; y = 2"), std::vector<std::string>{"name:x", "=", "1"});
+    CHECK_EQ(Lex("X"), std::vector<std::string>{});
+}
+
+TEST(SourceFileReadsTheWholeFile) {
+    const auto path = (std::filesystem::temp_directory_path() / "dataflow-lexer-test.txt").string();
+    const std::string text = "x = 1\ny = x\n";
+    std::ofstream(path) << text;
+    {
+        SourceFile file(path);
+        CHECK_EQ(file.Text(), text);
+    }
+    std::ofstream(path).close();
+    {
+        SourceFile empty(path);
+        CHECK(empty.Text().empty());
+    }
+    std::filesystem::remove(path);
+    CHECK_THROWS(SourceFile{path});
+}
+
+}
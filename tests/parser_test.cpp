@@ -0,0 +1,61 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <string>
+#include <string_view>
+#include "check.h"
+#include "parser.h"
+#include "reports.h"
+
+namespace {
+
+// Each one misses an operand or a statement.
+const std::string_view kMalformed[] = {
+    "x = \n",
+    "x = 1\ny = \n",
+    "x = (\n",
+    "x = 1 +\n",
+    "x = (1 + )\n",
+    "if\n  x = 1\nend\n",
+    "while (x < 1)\nend\n",
+};
+
+// Rejected with an exception instead of leaving a null node for the
+// analyses to dereference.
+TEST(MalformedProgramsAreRejected) {
+    for (const auto source: kMalformed) {
+        Context context(std::string{source});
+        CHECK_THROWS(Parser(source).ParseProgram());
+        CHECK_THROWS(Streamed(source));
+    }
+}
+
+constexpr int kDeep = 100000;
+
+// Deeper than any call stack would take, were statements or expressions
+// parsed, printed or analysed recursively.
+TEST(DeepNestingIsNotLimitedByTheStack) {
+    std::string ifs;
+    for (int i = 0; i < kDeep; ++i) {
+        ifs += "if (a > 0)\n";
+    }
+    ifs += "x = 1\n";
+    for (int i = 0; i < kDeep; ++i) {
+        ifs += "end\n";
+    }
+    auto program = Parser(ifs).ParseProgram();
+    CHECK_EQ(program->statement_count, static_cast<uint32_t>(kDeep + 1));
+    CHECK(Text(*program->statements.front()).find("x = 1") != std::string::npos);
+    CHECK_EQ(Mixed(ifs), Report{"x = 1"});
+    CHECK_EQ(Streamed(ifs), Report{"x = 1"});
+    CHECK_EQ(Ssa(ifs), Report{"x = 1"});
+
+    const auto parentheses = "x = " + std::string(kDeep, '(') + "1" + std::string(kDeep, ')') + "\ny = x\n";
+    program = Parser(parentheses).ParseProgram();
+    CHECK_EQ(Text(*program->statements.front()), parentheses.substr(0, parentheses.find('\n')));
+    CHECK_EQ(Mixed(parentheses), Report{"y = x"});
+    CHECK_EQ(Ssa(parentheses), Report{"y = x"});
+}
+
+}
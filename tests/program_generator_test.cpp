@@ -0,0 +1,44 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <algorithm>
+#include <string>
+#include "check.h"
+#include "parser.h"
+#include "program_generator.h"
+
+namespace {
+
+// The deepest nesting of ifs and whiles, from the indentation of the lines.
+size_t Depth(const std::string& source) {
+    size_t depth = 0;
+    for (size_t line = 0; line < source.size(); line = source.find('\n', line) + 1) {
+        const auto indent = source.find_first_not_of(' ', line) - line;
+        depth = std::max(depth, indent / 2);
+    }
+    return depth;
+}
+
+// Benchmarks compare runs on the same seed, so it has to give the same
+// program every time.
+TEST(SameSeedSameProgram) {
+    const ProgramShape shape;
+    CHECK_EQ(GenerateProgram(shape, 7), GenerateProgram(shape, 7));
+    CHECK(GenerateProgram(shape, 7) != GenerateProgram(shape, 8));
+}
+
+TEST(ProgramsParseToTheirShape) {
+    for (const uint32_t max_depth: {0u, 2u, 6u}) {
+        for (uint64_t seed = 1; seed <= 5; ++seed) {
+            Context context("depth " + std::to_string(max_depth) + ", seed " + std::to_string(seed));
+            const ProgramShape shape{.statements = 300, .max_depth = max_depth};
+            const auto source = GenerateProgram(shape, seed);
+            const auto program = Parser(source).ParseProgram();
+            CHECK_EQ(program->statement_count, shape.statements);
+            CHECK(Depth(source) <= max_depth);
+        }
+    }
+}
+
+}
@@ -0,0 +1,71 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <algorithm>
+#include <sstream>
+#include "parser.h"
+#include "reports.h"
+#include "server.h"
+
+std::string Text(const Statement& statement) {
+    std::ostringstream text;
+    text << statement;
+    return std::move(text).str();
+}
+
+Report Lines(const std::vector<Statement*>& statements) {
+    Report report;
+    for (const auto* statement: statements) {
+        report.push_back(Text(*statement));
+    }
+    return report;
+}
+
+Report Mixed(std::string_view source, ValueDomain domain) {
+    Parser parser(source);
+    auto program = parser.ParseProgram();
+    MixedAnalyser analyser;
+    analyser.possible_value_analyzer.domain = domain;
+    analyser.Analyse(*program);
+    return Lines(analyser.unused);
+}
+
+Report Ssa(std::string_view source) {
+    Parser parser(source);
+    auto program = parser.ParseProgram();
+    SsaAnalyser analyser;
+    analyser.Analyse(*program);
+    return Lines(analyser.unused);
+}
+
+Report Streamed(std::string_view source, ValueDomain domain) {
+    Parser parser(source);
+    StreamingAnalyser analyser;
+    analyser.possible_value_analyzer.domain = domain;
+    Report report;
+    while (auto* program = parser.ParseNextStatement()) {
+        analyser.Analyse(*program);
+        report.insert(report.end(), analyser.unused.begin(), analyser.unused.end());
+    }
+    analyser.Finish();
+    report.insert(report.end(), analyser.unused.begin(), analyser.unused.end());
+    return Sorted(std::move(report));
+}
+
+Report Sorted(Report report) {
+    std::ranges::sort(report);
+    return report;
+}
+
+Report Served(Server& server, std::string_view requests) {
+    std::istringstream in{std::string(requests)};
+    std::ostringstream out;
+    server.Serve(in, out);
+    Report responses;
+    std::istringstream lines(std::move(out).str());
+    for (std::string line; std::getline(lines, line);) {
+        responses.push_back(line);
+    }
+    return responses;
+}
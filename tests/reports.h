@@ -0,0 +1,35 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "analysis.h"
+
+class Server;
+
+// The reports of the analysers on a source, one line per statement as the
+// tool prints them.
+using Report = std::vector<std::string>;
+
+std::string Text(const Statement& statement);
+
+Report Lines(const std::vector<Statement*>& statements);
+
+// Unused assignments found by the mixed analyser, in program order.
+Report Mixed(std::string_view source, ValueDomain domain = ValueDomain::kValueSet);
+
+Report Ssa(std::string_view source);
+
+// Unused assignments found by --stream, sorted: they are reported as they
+// are found rather than in program order.
+Report Streamed(std::string_view source, ValueDomain domain = ValueDomain::kValueSet);
+
+Report Sorted(Report report);
+
+// The responses of the server to the requests of one client.
+Report Served(Server& server, std::string_view requests);
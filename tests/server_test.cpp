@@ -0,0 +1,91 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "directory.h"
+#include "reports.h"
+#include "server.h"
+
+namespace {
+
+std::string Source(std::string_view source) {
+    return "source " + std::to_string(source.size()) + "\n" + std::string(source);
+}
+
+TEST(SourcesAndFilesAreAnalysed) {
+    Directory directory("dataflow-server-test-files");
+    const auto path = directory.Write("program.txt", "x = 5\nx = 6\na = x\n");
+    Server server(ValueDomain::kValueSet, {}, 2);
+    CHECK_EQ(Served(server, Source("x = 5\nx = 6\na = x\n")
+                            + "file " + path + "\n"
+                            "source 0\n"),
+             Report{"ok 2", "x = 5", "a = x", "ok 2", "x = 5", "a = x", "error Expected statement"});
+}
+
+// A request that fails is answered with an error, and the server goes on
+// with the next one.
+TEST(FailedRequestsAreAnsweredInPlace) {
+    Server server(ValueDomain::kValueSet, {}, 2);
+    CHECK_EQ(Served(server, "source 6\nx = 1\nsource 4\nx = \nsource 6\nx = 2\n"),
+             Report{"ok 1", "x = 1", "error Expected expression", "ok 1", "x = 2"});
+    CHECK_EQ(Served(server, "source 18446744073709551615\n"), Report{"error source too large"});
+    CHECK_EQ(Served(server, "source -1\nsource x\nanalyse\nsource 6\nx = 1\n"),
+             Report{"error invalid length", "error invalid length", "error unknown request", "ok 1", "x = 1"});
+    const auto missing = Served(server, "file /nonexistent/program.txt\nsource 6\nx = 1\n");
+    CHECK_EQ(missing.size(), 3u);
+    CHECK(!missing.empty() && missing.front().starts_with("error "));
+}
+
+// A source cut short by the end of the input is not answered.
+TEST(TruncatedSourcesEndTheSession) {
+    Server server(ValueDomain::kValueSet, {}, 1);
+    CHECK_EQ(Served(server, "source 6\nx = 1\nsource 100\nx = 2\n"), Report{"ok 1", "x = 1"});
+}
+
+// Clients are served at the same time by one server, each getting its own
+// responses in order.
+TEST(ClientsAreServedConcurrently) {
+    Server server(ValueDomain::kValueSet, {}, 4);
+    std::vector<Report> responses(8);
+    std::vector<std::thread> clients;
+    for (size_t i = 0; i < responses.size(); ++i) {
+        clients.emplace_back([&, i] {
+            std::string requests;
+            for (int j = 0; j < 20; ++j) {
+                requests += Source("x = " + std::to_string(10 + j) + "\nx = 1\n");
+            }
+            responses[i] = Served(server, requests);
+        });
+    }
+    for (auto& client: clients) {
+        client.join();
+    }
+    Report expected;
+    for (int j = 0; j < 20; ++j) {
+        expected.insert(expected.end(), {"ok 2", "x = " + std::to_string(10 + j), "x = 1"});
+    }
+    for (const auto& response: responses) {
+        CHECK_EQ(response, expected);
+    }
+}
+
+// Sources are budgeted and say which loops were cut short.
+TEST(SourcesAreBudgeted) {
+    Server server(ValueDomain::kValueSet, {.combinations = 1}, 1);
+    CHECK_EQ(Served(server, Source("x = 1\n"
+                                   "while (x < 20)\n"
+                                   "  if (x > 10)\n"
+                                   "    x = x + 2\n"
+                                   "  end\n"
+                                   "  x = x + 1\n"
+                                   "end\n"
+                                   "y = x\n")),
+             Report{"ok 2", "y = x", "reduced precision: while (x < 20)"});
+}
+
+}
@@ -0,0 +1,122 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "check.h"
+#include "reports.h"
+#include "statistics.h"
+
+namespace {
+
+// Collects the statistics of the current thread for its scope.
+class Collecting {
+public:
+    explicit Collecting(Statistics& statistics) {
+        Statistics::current = &statistics;
+    }
+
+    Collecting(const Collecting&) = delete;
+
+    Collecting& operator=(const Collecting&) = delete;
+
+    ~Collecting() {
+        Statistics::current = nullptr;
+    }
+};
+
+TEST(CountsOnlyWhenCollecting) {
+    Statistics::Add(&Statistics::state_copies);
+    Statistics statistics;
+    {
+        Collecting collecting(statistics);
+        Statistics::Add(&Statistics::state_copies);
+        Statistics::Add(&Statistics::state_copies, 2);
+        Statistics::Max(&Statistics::max_loop_depth, 4);
+        Statistics::Max(&Statistics::max_loop_depth, 3);
+    }
+    Statistics::Add(&Statistics::state_copies);
+    CHECK_EQ(statistics.state_copies, 3u);
+    CHECK_EQ(statistics.max_loop_depth, 4u);
+}
+
+TEST(AnalysesAreCounted) {
+    Statistics statistics;
+    {
+        Collecting collecting(statistics);
+        Mixed("x = 1\n"
+              "while (x < 13)\n"
+              "  x = x + 1\n"
+              "end\n"
+              "if (x > a)\n"
+              "  y = x * 2\n"
+              "end\n");
+    }
+    CHECK(statistics.expression_evaluations > 0);
+    CHECK(statistics.combinations_evaluated > 0);
+    CHECK_EQ(statistics.loop_summaries, 1u);
+    CHECK(statistics.possible_values_ms >= 0);
+}
+
+Statistics Collected(std::string_view source) {
+    Statistics statistics;
+    Collecting collecting(statistics);
+    Mixed(source);
+    return statistics;
+}
+
+// A loop is left once an iteration changes nothing, and an inner loop that
+// is entered with the same values as before is not analysed again.
+TEST(LoopsLeftEarlyAreCounted) {
+    const auto fixpoint = Collected("c = 0\n"
+                                    "if (a > 0)\n"
+                                    "  c = 1\n"
+                                    "end\n"
+                                    "while (c > 0)\n"
+                                    "  y = 1\n"
+                                    "end\n");
+    CHECK_EQ(fixpoint.loop_fixpoints, 1u);
+    const auto reused = Collected("i = 0\n"
+                                  "while (i < 20)\n"
+                                  "  k = 3\n"
+                                  "  while (k > 0)\n"
+                                  "    k = k / 2\n"
+                                  "  end\n"
+                                  "  i = i + 1\n"
+                                  "end\n");
+    CHECK_EQ(reused.loop_exit_reuses, 19u);
+    CHECK_EQ(reused.loop_depth_limit_hits, 0u);
+}
+
+// Counts add up over the files of a batch, and maxima stay maxima.
+TEST(MergeAddsCountsAndKeepsMaxima) {
+    Statistics total;
+    total.expression_evaluations = 5;
+    total.max_loop_depth = 7;
+    total.parse_ms = 1.5;
+    Statistics file;
+    file.expression_evaluations = 2;
+    file.max_loop_depth = 3;
+    file.parse_ms = 0.25;
+    total.Merge(file);
+    CHECK_EQ(total.expression_evaluations, 7u);
+    CHECK_EQ(total.max_loop_depth, 7u);
+    CHECK_EQ(total.parse_ms, 1.75);
+}
+
+TEST(WritesOneJsonObject) {
+    Statistics statistics;
+    statistics.expression_evaluations = 12;
+    statistics.budget_cutoffs = 1;
+    std::ostringstream out;
+    statistics.WriteJson(out);
+    const auto json = std::move(out).str();
+    CHECK(json.starts_with("{\"expression_evaluations\": 12, "));
+    CHECK(json.find("\"budget_cutoffs\": 1,") != std::string::npos);
+    CHECK(json.ends_with("}"));
+    CHECK(json.find('\n') == std::string::npos);
+}
+
+}
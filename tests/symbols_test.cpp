@@ -0,0 +1,66 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <memory>
+#include <string>
+#include "check.h"
+#include "parser.h"
+#include "symbols.h"
+
+namespace {
+
+TEST(SymbolsAreDenseInOrderOfFirstSight) {
+    SymbolTable symbols;
+    CHECK_EQ(symbols.Intern("b"), 0u);
+    CHECK_EQ(symbols.Intern("count"), 1u);
+    CHECK_EQ(symbols.Intern("a"), 2u);
+    CHECK_EQ(symbols.Intern("b"), 0u);
+    CHECK_EQ(symbols.Intern("count"), 1u);
+    CHECK_EQ(symbols.size(), 3u);
+    CHECK_EQ(symbols.Name(1), "count");
+}
+
+// Whole identifiers tell names apart, not their first letter.
+TEST(LongNamesAreTheirOwn) {
+    SymbolTable symbols;
+    const auto c = symbols.Intern("c");
+    const auto cat = symbols.Intern("cat");
+    const auto car = symbols.Intern("car");
+    CHECK(c != cat);
+    CHECK(cat != car);
+    CHECK_EQ(symbols.Name(cat), "cat");
+    CHECK_EQ(symbols.Name(car), "car");
+}
+
+// Names stay where they are as the table grows, since nodes point to them.
+TEST(NamesKeepTheirPlace) {
+    SymbolTable symbols;
+    const auto* first = &symbols.Name(symbols.Intern("first"));
+    for (int i = 0; i < 10000; ++i) {
+        symbols.Intern("name" + std::to_string(i));
+    }
+    CHECK_EQ(&symbols.Name(symbols.Intern("first")), first);
+}
+
+TEST(ClearNumbersFromZeroAgain) {
+    SymbolTable symbols;
+    symbols.Intern("x");
+    symbols.Intern("yy");
+    symbols.Clear();
+    CHECK_EQ(symbols.size(), 0u);
+    CHECK_EQ(symbols.Intern("yy"), 0u);
+    CHECK_EQ(symbols.Intern("x"), 1u);
+}
+
+// Programs parsed with the same table number their variables alike.
+TEST(ProgramsShareATable) {
+    const auto symbols = std::make_shared<SymbolTable>();
+    auto first = Parser("total = 1\n", symbols).ParseProgram();
+    auto second = Parser("x = 2\ntotal = x\n", symbols).ParseProgram();
+    CHECK_EQ(first->assignments[0]->variable->name, second->assignments[1]->variable->name);
+    CHECK_EQ(std::string(second->assignments[1]->variable->identifier), "total");
+    CHECK_EQ(symbols->size(), 2u);
+}
+
+}
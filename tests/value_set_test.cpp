@@ -0,0 +1,75 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <climits>
+#include <vector>
+#include "check.h"
+#include "value_set.h"
+
+namespace {
+
+ValueSet Of(const std::vector<int>& sorted) {
+    return ValueSet::FromSorted(sorted.data(), sorted.size());
+}
+
+std::vector<int> Values(const ValueSet& set) {
+    std::vector<int> values;
+    set.ForEach([&](int value) { values.push_back(value); });
+    return values;
+}
+
+// Within 64 consecutive integers the set is a bitmap, beyond that an array;
+// both give the values back in order.
+TEST(HoldsCloseAndSpreadValues) {
+    const auto close = Of({-3, 0, 60});
+    CHECK_EQ(Values(close), std::vector<int>{-3, 0, 60});
+    CHECK_EQ(close.min(), -3);
+    CHECK_EQ(close.max(), 60);
+    const auto spread = Of({INT_MIN, 0, INT_MAX});
+    CHECK_EQ(Values(spread), std::vector<int>{INT_MIN, 0, INT_MAX});
+    CHECK_EQ(spread.min(), INT_MIN);
+    CHECK_EQ(spread.max(), INT_MAX);
+    CHECK(spread.contains(0));
+    CHECK(!spread.contains(1));
+    CHECK_EQ(Values(ValueSet::Consecutive(INT_MAX - 2, INT_MAX)), std::vector<int>{INT_MAX - 2, INT_MAX - 1, INT_MAX});
+}
+
+// Each set has one representation, however it was built.
+TEST(EqualSetsCompareEqual) {
+    auto merged = Of({1, 1000});
+    CHECK(merged.EraseOutside(0, 100));
+    CHECK(merged == ValueSet::Single(1));
+    CHECK_EQ(merged.Hash(), ValueSet::Single(1).Hash());
+
+    auto grown = ValueSet::Single(5);
+    CHECK(grown.Merge(ValueSet::Single(-2)));
+    CHECK(grown == Of({-2, 5}));
+    CHECK(grown.Merge(Of({100000})));
+    CHECK(grown == Of({-2, 5, 100000}));
+    CHECK_EQ(grown.Hash(), Of({-2, 5, 100000}).Hash());
+    CHECK(!(grown == Of({-2, 5})));
+}
+
+// A merge that would go beyond kCapacity leaves the set as it was.
+TEST(MergesUpToCapacity) {
+    auto set = ValueSet::Consecutive(0, ValueSet::kCapacity - 2);
+    CHECK(set.Merge(ValueSet::Single(1000)));
+    CHECK_EQ(set.size(), ValueSet::kCapacity);
+    const auto full = set;
+    CHECK(!set.Merge(ValueSet::Single(-1000)));
+    CHECK(set == full);
+    CHECK(set.Merge(ValueSet::Single(3)));
+}
+
+TEST(ErasesAndIncludes) {
+    auto set = Of({-10, 0, 10, 20});
+    CHECK(set.Includes(Of({0, 20})));
+    CHECK(!set.Includes(Of({0, 5})));
+    CHECK(set.EraseOutside(0, 10));
+    CHECK_EQ(Values(set), std::vector<int>{0, 10});
+    CHECK(!set.EraseOutside(int64_t{INT_MAX} + 1, int64_t{INT_MAX} + 5));
+    CHECK(set.empty());
+}
+
+}
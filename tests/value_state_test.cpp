@@ -0,0 +1,88 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <thread>
+#include "check.h"
+#include "value_state.h"
+
+namespace {
+
+// In the first page and in a later one.
+constexpr Symbol kFirst = 3;
+constexpr Symbol kLater = 100;
+
+ValueState Example() {
+    ValueState state;
+    state.Set(kFirst, ValueSet::Single(1));
+    state.Set(kLater, ValueSet::Single(2));
+    return state;
+}
+
+TEST(CopiesAreIndependent) {
+    auto original = Example();
+    auto copy = original;
+    copy.Set(kFirst, ValueSet::Single(5));
+    copy.Modify(kLater) = ValueSet::Single(6);
+    CHECK(original.Get(kFirst) == ValueSet::Single(1));
+    CHECK(original.Get(kLater) == ValueSet::Single(2));
+    CHECK(copy.Get(kFirst) == ValueSet::Single(5));
+    CHECK(copy.Get(kLater) == ValueSet::Single(6));
+}
+
+// A copy shares the table, and the first change copies the table and the
+// page it touches only.
+TEST(CopiesAllocateOnTheirFirstChange) {
+    const auto original = Example();
+    const auto before_copy = ValueState::AllocatedBytes();
+    auto copy = original;
+    CHECK_EQ(ValueState::AllocatedBytes(), before_copy);
+    copy.Set(kLater, ValueSet::Single(7));
+    const auto first_change = ValueState::AllocatedBytes() - before_copy;
+    CHECK(first_change > 0);
+    copy.Set(kLater, ValueSet::Single(8));
+    copy.Set(kLater + 1, ValueSet::Single(8));
+    CHECK_EQ(ValueState::AllocatedBytes() - before_copy, first_change);
+}
+
+TEST(SharedValuesAreToldWithoutComparing) {
+    auto original = Example();
+    auto copy = original;
+    CHECK(copy.SharesValues(original, kFirst));
+    CHECK(copy.SharesValues(original, kLater));
+    copy.Set(kFirst, ValueSet::Single(1));
+    CHECK(!copy.SharesValues(original, kFirst));
+    CHECK(copy.SharesValues(original, kLater));
+    copy.Share(kFirst, original);
+    CHECK(copy.SharesValues(original, kFirst));
+}
+
+// Equality compares contents when the stamps differ, set or not.
+TEST(StatesBuiltApartCompareByContents) {
+    auto a = Example();
+    auto b = Example();
+    CHECK(a == b);
+    CHECK(a.HoldsSame(b, a.Names()));
+    CHECK_EQ(a.Hash(a.Names()), b.Hash(b.Names()));
+    b.SetUnknown(kFirst);
+    CHECK(!(a == b));
+    a.SetUnknown(kFirst);
+    CHECK(a == b);
+    CHECK_EQ(a.KindOf(kLater + 5), ValueState::Kind::kUnset);
+    b.Get(kLater + 5);
+    CHECK(!a.HoldsSame(b, b.Names()));
+}
+
+// Stamps come from one counter for the whole process, so states built on
+// different threads, such as the versions of a buffer analysed on different
+// workers, never take each other's slots for shared.
+TEST(StatesBuiltOnOtherThreadsAreNotShared) {
+    ValueState a;
+    ValueState b;
+    std::thread([&] { a.Set(kFirst, ValueSet::Single(1)); }).join();
+    std::thread([&] { b.Set(kFirst, ValueSet::Single(2)); }).join();
+    CHECK(!a.SharesValues(b, kFirst));
+    CHECK(!(a == b));
+}
+
+}
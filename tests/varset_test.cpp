@@ -0,0 +1,70 @@
+//
+// Created by Aleksandr Lvov on 17/10/2026.
+//
+
+#include <vector>
+#include "check.h"
+#include "varset.h"
+
+namespace {
+
+std::vector<Symbol> Elements(const VarSet& set) {
+    std::vector<Symbol> elements;
+    for (const auto name: set) {
+        elements.push_back(name);
+    }
+    return elements;
+}
+
+TEST(InsertsAndErasesAcrossWords) {
+    VarSet set;
+    CHECK(set.empty());
+    for (const Symbol name: {0u, 63u, 64u, 200u, 5u}) {
+        set.insert(name);
+    }
+    CHECK_EQ(Elements(set), std::vector<Symbol>{0, 5, 63, 64, 200});
+    CHECK_EQ(set.size(), 5u);
+    CHECK(set.contains(200));
+    CHECK(!set.contains(199));
+    CHECK(!set.contains(1000));
+    CHECK_EQ(set.erase(200), 1u);
+    CHECK_EQ(set.erase(200), 0u);
+    CHECK_EQ(set.erase(1000), 0u);
+    CHECK_EQ(Elements(set), std::vector<Symbol>{0, 5, 63, 64});
+}
+
+TEST(SetOperations) {
+    VarSet a;
+    VarSet b;
+    a.insert_range(std::vector<Symbol>{1, 2, 70, 130});
+    b.insert_range(std::vector<Symbol>{2, 3, 130});
+
+    auto merged = a;
+    merged.merge(b);
+    CHECK_EQ(Elements(merged), std::vector<Symbol>{1, 2, 3, 70, 130});
+
+    auto subtracted = a;
+    subtracted.subtract(b);
+    CHECK_EQ(Elements(subtracted), std::vector<Symbol>{1, 70});
+
+    auto intersected = a;
+    intersected.intersect(b);
+    CHECK_EQ(Elements(intersected), std::vector<Symbol>{2, 130});
+}
+
+// Sets grown to different sizes are equal when they hold the same names.
+TEST(EqualityIgnoresTrailingWords) {
+    VarSet small;
+    VarSet grown;
+    small.insert(3);
+    grown.insert(3);
+    grown.insert(300);
+    CHECK(!(small == grown));
+    grown.erase(300);
+    CHECK(small == grown);
+    CHECK(grown.size() == 1);
+    grown.erase(3);
+    CHECK(grown.empty());
+}
+
+}